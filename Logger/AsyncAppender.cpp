@@ -0,0 +1,95 @@
+#include "../include/AsyncAppender.h"
+#include <utility>
+
+AsyncAppender::AsyncAppender(std::shared_ptr<LogAppender> sink, AsyncAppenderOptions options)
+    : sink(sink), options(options), flushWaiters(0), stopping(false), stats()
+{
+    if (this->options.capacity == 0)
+        this->options.capacity = 1;
+    if (this->options.batchSize == 0 || this->options.batchSize > this->options.capacity)
+        this->options.batchSize = this->options.capacity;
+
+    worker = std::thread(&AsyncAppender::run, this);
+}
+
+AsyncAppender::~AsyncAppender() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    workAvailable.notify_one();
+    spaceAvailable.notify_all();
+    worker.join();
+}
+
+void AsyncAppender::append(const LogMessage& logMessage) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (pending.size() >= options.capacity) {
+        if (options.overflow == AsyncOverflowPolicy::Drop || stopping) {
+            ++stats.dropped;
+            return;
+        }
+        spaceAvailable.wait(lock, [this] { return pending.size() < options.capacity || stopping; });
+    }
+
+    if (pending.empty())
+        oldestPending = std::chrono::steady_clock::now();
+    pending.push_back(logMessage);
+    ++stats.accepted;
+    if (pending.size() > stats.maxQueueDepth)
+        stats.maxQueueDepth = pending.size();
+
+    // The background thread only needs a nudge to start its timer and when a batch is full
+    bool wake = pending.size() == 1 || pending.size() == options.batchSize;
+    lock.unlock();
+    if (wake)
+        workAvailable.notify_one();
+}
+
+void AsyncAppender::flush() {
+    std::unique_lock<std::mutex> lock(mtx);
+    uint64_t target = stats.accepted;
+    ++flushWaiters;
+    workAvailable.notify_one();
+    batchWritten.wait(lock, [this, target] { return stats.written >= target; });
+    --flushWaiters;
+}
+
+AsyncAppenderStats AsyncAppender::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    AsyncAppenderStats snapshot = stats;
+    snapshot.queueDepth = pending.size();
+    return snapshot;
+}
+
+void AsyncAppender::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        if (pending.empty()) {
+            if (stopping)
+                break;
+            workAvailable.wait(lock, [this] { return stopping || !pending.empty(); });
+            continue;
+        }
+
+        // Let the batch fill up, unless someone is waiting for it
+        if (pending.size() < options.batchSize && !stopping && flushWaiters == 0) {
+            workAvailable.wait_until(lock, oldestPending + options.maxDelay, [this] {
+                return stopping || flushWaiters > 0 || pending.size() >= options.batchSize;
+            });
+        }
+
+        std::swap(pending, writing);    // pending gets the old batch's capacity back
+        lock.unlock();
+        spaceAvailable.notify_all();
+
+        sink->appendBatch(writing);
+        size_t count = writing.size();
+        writing.clear();
+
+        lock.lock();
+        stats.written += count;
+        ++stats.batches;
+        batchWritten.notify_all();
+    }
+}
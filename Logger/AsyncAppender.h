@@ -0,0 +1,74 @@
+#pragma once
+#include "LogAppender.h"
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// What append() does when the queue already holds `capacity` messages
+enum class AsyncOverflowPolicy {
+    Drop,   // count the message as dropped and return at once
+    Block   // wait for the background thread to make room
+};
+
+struct AsyncAppenderOptions {
+    size_t capacity = 8192;                             // messages that may wait for the sink
+    size_t batchSize = 256;                             // hand a batch to the sink once this many are queued...
+    std::chrono::milliseconds maxDelay{ 50 };           // ...or once the oldest queued message is this old
+    AsyncOverflowPolicy overflow = AsyncOverflowPolicy::Drop;
+};
+
+struct AsyncAppenderStats {
+    size_t queueDepth;          // messages waiting right now
+    size_t maxQueueDepth;       // highest queueDepth seen
+    uint64_t accepted;          // messages queued by append()
+    uint64_t written;           // messages the sink has received
+    uint64_t dropped;           // messages refused because the queue was full
+    uint64_t batches;           // appendBatch calls made on the sink
+};
+
+// Decorator Pattern: puts a bounded queue and a background thread in
+// front of any LogAppender. append() only copies the message into the
+// queue, so callers never wait on the sink's I/O; the background thread
+// hands the sink whole batches through appendBatch.
+class AsyncAppender : public LogAppender {
+private:
+    std::shared_ptr<LogAppender> sink;
+    AsyncAppenderOptions options;
+
+    // Double buffer: callers fill pending, the background thread swaps it
+    // with writing and writes that without holding the lock
+    std::vector<LogMessage> pending;
+    std::vector<LogMessage> writing;
+    std::chrono::steady_clock::time_point oldestPending;
+
+    mutable std::mutex mtx;
+    std::condition_variable workAvailable;
+    std::condition_variable spaceAvailable;
+    std::condition_variable batchWritten;
+
+    size_t flushWaiters;
+    bool stopping;
+    AsyncAppenderStats stats;
+
+    std::thread worker;
+
+    void run();
+
+public:
+    explicit AsyncAppender(std::shared_ptr<LogAppender> sink, AsyncAppenderOptions options = AsyncAppenderOptions());
+    ~AsyncAppender() override;     // writes everything still queued
+
+    AsyncAppender(const AsyncAppender&) = delete;
+    AsyncAppender& operator=(const AsyncAppender&) = delete;
+
+    void append(const LogMessage& logMessage) override;
+
+    // Blocks until every message accepted so far has reached the sink
+    void flush();
+
+    AsyncAppenderStats getStats() const;
+};
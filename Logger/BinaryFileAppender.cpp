@@ -0,0 +1,62 @@
+#include "../include/LogAppender.h"
+#include "../MultiThreading/ConcurrentLogger/ConcurrentLogger/binary_log_format.h"
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+
+BinaryFileAppender::BinaryFileAppender(const std::string& filePath)
+    : filePath(filePath), file(filePath, std::ios::app | std::ios::binary), lastTimestamp(0) {
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+        return;
+    }
+
+    // Every run starts with a header, so runs appended to the same file decode independently
+    binlog::appendHeader(buffer);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    buffer.clear();
+}
+
+void BinaryFileAppender::encode(const LogMessage& logMessage) {
+    long long timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::duration(logMessage.getTimestamp())).count();
+    long long delta = timestamp - lastTimestamp;
+    lastTimestamp = timestamp;
+
+    const std::string message = logMessage.getMessage();
+    uint32_t length = static_cast<uint32_t>(message.size());
+
+    buffer.push_back(static_cast<char>(binlog::RecordTag));
+    binlog::appendVarint(buffer, binlog::zigzag(delta));
+    buffer.push_back(static_cast<char>(logMessage.getLevel()));
+    binlog::appendVarint(buffer, binlog::TextFormatId);
+    binlog::appendVarint(buffer, sizeof(length) + length);
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    buffer.append(message);
+}
+
+void BinaryFileAppender::append(const LogMessage& logMessage) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file.is_open()) {
+        encode(logMessage);
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.flush();
+        buffer.clear();
+    } else {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+    }
+}
+
+void BinaryFileAppender::appendBatch(const std::vector<LogMessage>& logMessages) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file.is_open()) {
+        for (const LogMessage& logMessage : logMessages)
+            encode(logMessage);
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.flush();
+        buffer.clear();
+    } else {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+    }
+}
@@ -4,3 +4,10 @@
 void ConsoleAppender::append(const LogMessage& logMessage) {
     std::cout << logMessage.toString() << std::endl;
 }
+
+void ConsoleAppender::appendBatch(const std::vector<LogMessage>& logMessages) {
+    std::string lines;
+    for (const LogMessage& logMessage : logMessages)
+        lines += logMessage.toString() + '\n';
+    std::cout << lines << std::flush;
+}
@@ -1,13 +1,27 @@
 #include "../include/LogAppender.h"
 #include <iostream>
 
-FileAppender::FileAppender(const std::string& filePath) : filePath(filePath) {}
+FileAppender::FileAppender(const std::string& filePath) : filePath(filePath), file(filePath, std::ios::app) {
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+    }
+}
 
 void FileAppender::append(const LogMessage& logMessage) {
-    std::ofstream file(filePath, std::ios::app);
+    std::lock_guard<std::mutex> lock(fileMutex);
     if (file.is_open()) {
         file << logMessage.toString() << std::endl;
-        file.close();
+    } else {
+        std::cerr << "Failed to open file: " << filePath << std::endl;
+    }
+}
+
+void FileAppender::appendBatch(const std::vector<LogMessage>& logMessages) {
+    std::lock_guard<std::mutex> lock(fileMutex);
+    if (file.is_open()) {
+        for (const LogMessage& logMessage : logMessages)
+            file << logMessage.toString() << '\n';
+        file.flush();
     } else {
         std::cerr << "Failed to open file: " << filePath << std::endl;
     }
@@ -2,26 +2,63 @@
 #include "LogMessage.h"
 #include <string>
 #include <fstream>
+#include <mutex>
+#include <vector>
 
 // Strategy Pattern: Interface for different log appending strategies
 class LogAppender {
 public:
     virtual ~LogAppender() = default;
     virtual void append(const LogMessage& logMessage) = 0;
+
+    // Several messages at once (used by AsyncAppender); appenders that can
+    // write them in one go override this
+    virtual void appendBatch(const std::vector<LogMessage>& logMessages) {
+        for (const LogMessage& logMessage : logMessages)
+            append(logMessage);
+    }
 };
 
 // Console Appender - writes to stdout
 class ConsoleAppender : public LogAppender {
 public:
     void append(const LogMessage& logMessage) override;
+    void appendBatch(const std::vector<LogMessage>& logMessages) override;
 };
 
 // File Appender - writes to a file
+// The file is opened once and kept open; the mutex keeps lines from
+// different threads whole.
 class FileAppender : public LogAppender {
 private:
     std::string filePath;
+    std::ofstream file;
+    std::mutex fileMutex;
     
 public:
     explicit FileAppender(const std::string& filePath);
     void append(const LogMessage& logMessage) override;
+    void appendBatch(const std::vector<LogMessage>& logMessages) override;   // one flush per batch
+};
+
+// Binary File Appender - compact binary records instead of text lines,
+// encoded with MultiThreading/ConcurrentLogger's binary_log_format.h and
+// read back with its log_decoder. It only frames pre-formatted text:
+// messages arrive already formatted, so every record is the predefined
+// format 0 ("{}" with the message as its one string argument) and no
+// format table is ever written.
+class BinaryFileAppender : public LogAppender {
+private:
+    std::string filePath;
+    std::ofstream file;
+    std::mutex fileMutex;
+    std::string buffer;
+    long long lastTimestamp;    // ns; records store the delta to the previous one
+
+    void encode(const LogMessage& logMessage);
+    
+public:
+    explicit BinaryFileAppender(const std::string& filePath);
+    void append(const LogMessage& logMessage) override;
+    void appendBatch(const std::vector<LogMessage>& logMessages) override;
 };
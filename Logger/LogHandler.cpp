@@ -2,24 +2,75 @@
 #include <iostream>
 
 LogHandler::LogHandler(LogLevel level, std::shared_ptr<LogAppender> appender)
-    : level(level), appender(appender), nextHandler(nullptr) {}
+    : level(level), nextHandler(nullptr), appender(appender), previousHandler(nullptr), chainVersion(0) {}
+
+LogHandler::~LogHandler() {
+    if (nextHandler && nextHandler->previousHandler == this)
+        nextHandler->previousHandler = nullptr;
+}
 
 void LogHandler::setNextHandler(std::shared_ptr<LogHandler> next) {
+    if (nextHandler && nextHandler->previousHandler == this)
+        nextHandler->previousHandler = nullptr;
     nextHandler = next;
+    if (next)
+        next->previousHandler = this;
+
+    // This chain changed, and so did every chain that runs through it
+    for (LogHandler* handler = this; handler; handler = handler->previousHandler)
+        handler->chainVersion.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const LogHandler::DispatchTable> LogHandler::dispatchTable() {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::shared_ptr<const DispatchTable> table = dispatch.load(std::memory_order_acquire);
+#else
+    std::shared_ptr<const DispatchTable> table = std::atomic_load_explicit(&dispatch, std::memory_order_acquire);
+#endif
+    unsigned long version = chainVersion.load(std::memory_order_acquire);
+    if (table && table->version == version)
+        return table;
+
+    std::lock_guard<std::mutex> lock(buildMutex);
+#if defined(__cpp_lib_atomic_shared_ptr)
+    table = dispatch.load(std::memory_order_acquire);
+#else
+    table = std::atomic_load_explicit(&dispatch, std::memory_order_acquire);
+#endif
+    if (table && table->version == version)
+        return table;       // another thread just built it
+
+    auto built = std::make_shared<DispatchTable>();
+    built->version = version;
+    for (LogHandler* handler = this; handler; handler = handler->nextHandler.get()) {
+        //The handler processes messages at its level OR HIGHER severity. 
+        for (int msgLevel = static_cast<int>(handler->level); msgLevel <= 5; ++msgLevel)
+            built->byLevel[msgLevel - 1].push_back(handler);
+        if (handler->nextHandler)
+            built->downstream.push_back(handler->nextHandler);
+    }
+
+    table = built;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    dispatch.store(table, std::memory_order_release);       // the old table dies with its last reader
+#else
+    std::atomic_store_explicit(&dispatch, table, std::memory_order_release);
+#endif
+    return table;
 }
 
 void LogHandler::logMessage(LogLevel msgLevel, const std::string& message) {
-    if (static_cast<int>(this->level) <= static_cast<int>(msgLevel))//The handler processes messages at its level OR HIGHER severity. 
-    {
-        LogMessage logMsg(msgLevel, message);
-        if (appender) {
-            appender->append(logMsg);
+    std::shared_ptr<const DispatchTable> table = dispatchTable();
+    const std::vector<LogHandler*>& handlers = table->byLevel[static_cast<int>(msgLevel) - 1];
+    if (handlers.empty())
+        return;
+
+    LogMessage logMsg(msgLevel, message);  // one message (and timestamp) for every handler
+    for (LogHandler* handler : handlers) {
+        if (handler->appender) {
+            handler->appender->append(logMsg);
         }
-        write(message);
-    }
-    
-    if (nextHandler) {
-        nextHandler->logMessage(msgLevel, message);
+        handler->write(message);
     }
 }
 
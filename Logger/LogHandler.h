@@ -2,6 +2,10 @@
 #include "LogMessage.h"
 #include "LogAppender.h"
 #include <memory>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
 
 // Chain of Responsibility Pattern: Abstract base class for log handlers
 class LogHandler {
@@ -12,13 +16,44 @@ protected:
 
 public:
     LogHandler(LogLevel level, std::shared_ptr<LogAppender> appender);
-    virtual ~LogHandler() = default;
+    virtual ~LogHandler();
     
     void setNextHandler(std::shared_ptr<LogHandler> next);
     void logMessage(LogLevel level, const std::string& message);
     
 protected:
     virtual void write(const std::string& message) = 0;
+
+private:
+    /*
+        The chain starting at this handler, flattened per message level:
+        byLevel[l] lists, in chain order, every handler that takes level l.
+        logMessage builds one LogMessage and calls exactly those handlers,
+        so the cost no longer depends on how long the chain is.
+        chainVersion counts changes to the chain starting at this handler:
+        setNextHandler bumps it here and on every handler upstream (found
+        through previousHandler), so only the heads of that chain rebuild,
+        on their next message. A handler tracks the last handler linked to
+        it, so give each handler one predecessor. Tables are shared_ptr
+        snapshots: a replaced one is freed once the last reader drops it.
+        Configure the chain before logging to it from several threads.
+    */
+    struct DispatchTable {
+        std::array<std::vector<LogHandler*>, 5> byLevel;       // index: LogLevel value - 1
+        std::vector<std::shared_ptr<LogHandler>> downstream;   // keeps the handlers above alive
+        unsigned long version;
+    };
+
+    std::shared_ptr<const DispatchTable> dispatchTable();
+
+    LogHandler* previousHandler;                // the handler whose nextHandler is this one
+    std::atomic<unsigned long> chainVersion;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const DispatchTable>> dispatch;
+#else
+    std::shared_ptr<const DispatchTable> dispatch;   // only through std::atomic_load / std::atomic_store
+#endif
+    std::mutex buildMutex;
 };
 
 // Concrete Handlers
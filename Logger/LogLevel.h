@@ -8,6 +8,12 @@ enum class LogLevel {
     FATAL = 5
 };
 
+// Levels below this are compiled out of LOG_DEBUG ... LOG_FATAL and logAt
+// (LogMacros.h). Build with LOGGER_MIN_LEVEL=2 to drop every DEBUG call site.
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 1
+#endif
+
 inline const char* logLevelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG: return "DEBUG";
@@ -0,0 +1,56 @@
+#pragma once
+#include "Logger.h"
+
+/*
+    Front-ends that cost nothing for levels below LOGGER_MIN_LEVEL.
+
+    LOG_DEBUG(logger, message) ... LOG_FATAL(logger, message)
+        logger is a Logger* or std::shared_ptr<Logger>. The message
+        expression is only evaluated when the level is enabled at run time,
+        and a level below LOGGER_MIN_LEVEL expands to nothing at all: the
+        arguments are not even compiled.
+
+    logAt<LogLevel::DEBUG>(*logger, [&] { return ...; })
+        Template form with a lambda for the message. The compile-time check
+        is a constant, so the whole call folds away below the minimum.
+        MinLevel is a template parameter, so translation units built with
+        different LOGGER_MIN_LEVEL values do not clash.
+*/
+template<LogLevel Level, int MinLevel = LOGGER_MIN_LEVEL, typename MessageFn>
+inline void logAt(Logger& logger, MessageFn&& makeMessage) {
+    if (static_cast<int>(Level) >= MinLevel)
+        logger.logLazy(Level, makeMessage);
+}
+
+#define LOGGER_LOG_IF_ENABLED(logger, level, message) \
+    do { \
+        if ((logger)->isEnabled(level)) \
+            (logger)->log((level), (message)); \
+    } while (0)
+
+#if LOGGER_MIN_LEVEL <= 1
+#define LOG_DEBUG(logger, message) LOGGER_LOG_IF_ENABLED(logger, LogLevel::DEBUG, message)
+#else
+#define LOG_DEBUG(logger, message) do {} while (0)
+#endif
+
+#if LOGGER_MIN_LEVEL <= 2
+#define LOG_INFO(logger, message) LOGGER_LOG_IF_ENABLED(logger, LogLevel::INFO, message)
+#else
+#define LOG_INFO(logger, message) do {} while (0)
+#endif
+
+#if LOGGER_MIN_LEVEL <= 3
+#define LOG_WARNING(logger, message) LOGGER_LOG_IF_ENABLED(logger, LogLevel::WARNING, message)
+#else
+#define LOG_WARNING(logger, message) do {} while (0)
+#endif
+
+#if LOGGER_MIN_LEVEL <= 4
+#define LOG_ERROR(logger, message) LOGGER_LOG_IF_ENABLED(logger, LogLevel::ERROR, message)
+#else
+#define LOG_ERROR(logger, message) do {} while (0)
+#endif
+
+// FATAL is never compiled out
+#define LOG_FATAL(logger, message) LOGGER_LOG_IF_ENABLED(logger, LogLevel::FATAL, message)
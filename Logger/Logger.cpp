@@ -3,7 +3,8 @@
 std::unordered_map<std::string, std::shared_ptr<Logger>> Logger::instances;
 std::mutex Logger::mutex_;
 
-Logger::Logger(LogLevel logLevel, std::shared_ptr<LogAppender> logAppender) {
+Logger::Logger(LogLevel logLevel, std::shared_ptr<LogAppender> logAppender)
+    : minLevel(static_cast<int>(logLevel)) {
     //Minimum severity to log (e.g., INFO means ignore DEBUG)
     config = std::make_shared<LoggerConfig>(logLevel, logAppender);
 }
@@ -21,36 +22,31 @@ std::shared_ptr<Logger> Logger::getInstance(LogLevel logLevel, std::shared_ptr<L
     return instances[key];
 }
 
-void Logger::setConfig(std::shared_ptr<LoggerConfig> newConfig) {
-    std::lock_guard<std::mutex> lock(configMutex);
-    config = newConfig;
+std::shared_ptr<LoggerConfig> Logger::loadConfig() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+    return config.load(std::memory_order_acquire);
+#else
+    return std::atomic_load_explicit(&config, std::memory_order_acquire);
+#endif
 }
 
-void Logger::log(LogLevel level, const std::string& message) {
+void Logger::setConfig(std::shared_ptr<LoggerConfig> newConfig) {
     std::lock_guard<std::mutex> lock(configMutex);
-    
-    if (static_cast<int>(level) >= static_cast<int>(config->getLogLevel())) {
-        LogMessage logMessage(level, message);
-        config->getLogAppender()->append(logMessage);
-    }
+#if defined(__cpp_lib_atomic_shared_ptr)
+    config.store(newConfig, std::memory_order_release);
+#else
+    std::atomic_store_explicit(&config, newConfig, std::memory_order_release);
+#endif
+    minLevel.store(static_cast<int>(newConfig->getLogLevel()), std::memory_order_relaxed);
 }
 
-void Logger::debug(const std::string& message) {
-    log(LogLevel::DEBUG, message);
-}
+// Slow path: the level passed minLevel
+void Logger::write(LogLevel level, const std::string& message) {
+    std::shared_ptr<LoggerConfig> snapshot = loadConfig();
 
-void Logger::info(const std::string& message) {
-    log(LogLevel::INFO, message);
-}
-
-void Logger::warning(const std::string& message) {
-    log(LogLevel::WARNING, message);
-}
-
-void Logger::error(const std::string& message) {
-    log(LogLevel::ERROR, message);
-}
-
-void Logger::fatal(const std::string& message) {
-    log(LogLevel::FATAL, message);
+    // Decide with the snapshot's own level, in case setConfig ran in between
+    if (static_cast<int>(level) >= static_cast<int>(snapshot->getLogLevel())) {
+        LogMessage logMessage(level, message);
+        snapshot->getLogAppender()->append(logMessage);
+    }
 }
@@ -2,6 +2,7 @@
 #include "LoggerConfig.h"
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <unordered_map>
 #include <string>
 
@@ -17,12 +18,33 @@ private:
     static std::unordered_map<std::string, std::shared_ptr<Logger>> instances;
     static std::mutex mutex_;
     
-    std::shared_ptr<LoggerConfig> config;
+    /*
+        RCU-style config: log() never takes a lock.
+        - minLevel mirrors the current config's level, so filtering out a
+          message is one relaxed load and a compare.
+        - Messages that pass take a snapshot of the config pointer and use
+          only that snapshot, so a concurrent setConfig is seen either
+          entirely or not at all. The old config lives until its last
+          reader drops the snapshot.
+        - setConfig publishes a new pointer; configMutex only orders
+          writers against each other.
+        LoggerConfig has no setters, so a published config cannot change
+        under a reader or behind minLevel: publish a new one with setConfig.
+    */
+    std::atomic<int> minLevel;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<LoggerConfig>> config;
+#else
+    std::shared_ptr<LoggerConfig> config;   // only through std::atomic_load / std::atomic_store
+#endif
     std::mutex configMutex;
     
     // Private constructor
     Logger(LogLevel logLevel, std::shared_ptr<LogAppender> logAppender);
 
+    std::shared_ptr<LoggerConfig> loadConfig() const;
+    void write(LogLevel level, const std::string& message);
+
 public:
     // Delete copy constructor and assignment operator
     Logger(const Logger&) = delete;
@@ -30,13 +52,30 @@ public:
     
     static std::shared_ptr<Logger> getInstance(LogLevel logLevel, std::shared_ptr<LogAppender> logAppender);
     
-    void setConfig(std::shared_ptr<LoggerConfig> newConfig);// Change logger configuration at runtime
-    void log(LogLevel level, const std::string& message);
+    void setConfig(std::shared_ptr<LoggerConfig> newConfig);// Change logger configuration at runtime, readers never wait
+    std::shared_ptr<LoggerConfig> getConfig() const { return loadConfig(); }
+
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    void log(LogLevel level, const std::string& message) {
+        if (isEnabled(level))
+            write(level, message);
+    }
+
+    // Lazy form: makeMessage() (anything returning a string) only runs when the level is enabled
+    // logger->logLazy(LogLevel::DEBUG, [&] { return "state = " + dump(state); });
+    template<typename MessageFn>
+    void logLazy(LogLevel level, MessageFn&& makeMessage) {
+        if (isEnabled(level))
+            write(level, makeMessage());
+    }
     
-    // Convenience methods
-    void debug(const std::string& message);
-    void info(const std::string& message);
-    void warning(const std::string& message);
-    void error(const std::string& message);
-    void fatal(const std::string& message);
+    // Convenience methods (inline, so a filtered-out call is just the level check)
+    void debug(const std::string& message) { log(LogLevel::DEBUG, message); }
+    void info(const std::string& message) { log(LogLevel::INFO, message); }
+    void warning(const std::string& message) { log(LogLevel::WARNING, message); }
+    void error(const std::string& message) { log(LogLevel::ERROR, message); }
+    void fatal(const std::string& message) { log(LogLevel::FATAL, message); }
 };
@@ -4,18 +4,17 @@
 #include <memory>
 //bundles level + appender together
 //Allows runtime reconfiguration:
-//logger->setConfig(new LoggerConfig(LogLevel::DEBUG, fileAppender));
+//logger->setConfig(std::make_shared<LoggerConfig>(LogLevel::DEBUG, fileAppender));
+//Immutable: Logger reads a published config without a lock and caches its
+//level, so a config is never changed in place - publish a new one instead
 class LoggerConfig {
 private:
-    LogLevel logLevel;
-    std::shared_ptr<LogAppender> logAppender;
+    const LogLevel logLevel;
+    const std::shared_ptr<LogAppender> logAppender;
 
 public:
     LoggerConfig(LogLevel level, std::shared_ptr<LogAppender> appender);
     
     LogLevel getLogLevel() const { return logLevel; }
-    void setLogLevel(LogLevel level) { logLevel = level; }
-    
     std::shared_ptr<LogAppender> getLogAppender() const { return logAppender; }
-    void setLogAppender(std::shared_ptr<LogAppender> appender) { logAppender = appender; }
 };
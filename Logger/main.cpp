@@ -1,5 +1,16 @@
 #include "../include/Logger.h"
 #include "../include/LogHandler.h"
+#include "../include/AsyncAppender.h"
+#include "../include/LogMacros.h"
+#include "../MultiThreading/ConcurrentLogger/ConcurrentLogger/binary_log_format.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
@@ -15,6 +26,127 @@ std::shared_ptr<LogHandler> getChainOfLoggers(std::shared_ptr<LogAppender> appen
     return infoLogger;
 }
 
+// Appender that discards everything, to time the handler chain itself
+class NullAppender : public LogAppender {
+public:
+    void append(const LogMessage&) override {}
+};
+
+// ns per INFO message through a chain of `depth` handlers of which only the head takes INFO
+double nsPerChainMessage(int depth, int messages) {
+    auto nullAppender = std::make_shared<NullAppender>();
+    auto head = std::make_shared<InfoLogger>(LogLevel::INFO, nullAppender);
+    std::shared_ptr<LogHandler> tail = head;
+    for (int i = 1; i < depth; ++i) {
+        auto next = std::make_shared<ErrorLogger>(LogLevel::ERROR, nullAppender);
+        tail->setNextHandler(next);
+        tail = next;
+    }
+
+    const std::string message = "Chain message";
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; ++i) {
+        head->logMessage(LogLevel::INFO, message);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / messages;
+}
+
+// Reads a BinaryFileAppender file back the way log_decoder does and counts
+// the records whose level and text match `messages`, in order
+size_t roundTrip(const std::string& path, const std::vector<LogMessage>& messages) {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(bytes.data());
+    const unsigned char* end = p + bytes.size();
+    if (bytes.size() < 6 || p[0] != binlog::HeaderTag)
+        return 0;
+    p += 6;
+
+    size_t matched = 0;
+    for (const LogMessage& expected : messages) {
+        uint64_t delta, formatId, length;
+        if (p >= end || *p++ != binlog::RecordTag || !binlog::readVarint(p, end, delta) || p >= end)
+            break;
+        unsigned level = *p++;
+        if (!binlog::readVarint(p, end, formatId) || formatId != binlog::TextFormatId
+            || !binlog::readVarint(p, end, length) || length < sizeof(uint32_t) || static_cast<uint64_t>(end - p) < length)
+            break;
+        uint32_t textLength;
+        std::memcpy(&textLength, p, sizeof(textLength));
+        std::string text(reinterpret_cast<const char*>(p + sizeof(textLength)), length - sizeof(textLength));
+        p += length;
+        if (level == static_cast<unsigned>(expected.getLevel()) && textLength == text.size() && text == expected.getMessage())
+            ++matched;
+    }
+    return matched;
+}
+
+// Sink-side cost of writing `batch` in batches of 256 (what AsyncAppender's thread pays), and bytes per message
+void measureSink(const char* name, const std::string& path, const std::vector<LogMessage>& messages) {
+    std::remove(path.c_str());
+    std::shared_ptr<LogAppender> sink;
+    if (path.find(".bin") != std::string::npos)
+        sink = std::make_shared<BinaryFileAppender>(path);
+    else
+        sink = std::make_shared<FileAppender>(path);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < messages.size(); i += 256) {
+        std::vector<LogMessage> batch(messages.begin() + i, messages.begin() + std::min(i + 256, messages.size()));
+        sink->appendBatch(batch);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::ifstream written(path, std::ios::binary | std::ios::ate);
+    std::cout << name << elapsed.count() / messages.size() << " ns, "
+              << static_cast<double>(written.tellg()) / messages.size() << " bytes per message" << std::endl;
+}
+
+// Average cost of one log() call on the caller's thread
+double nsPerLog(std::shared_ptr<Logger> logger, int messages) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < messages; ++i) {
+        logger->info("Benchmark message " + std::to_string(i));
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / messages;
+}
+
+// Filtered-out calls per second (millions) over `threads` concurrent callers
+double disabledCallsPerSec(std::shared_ptr<Logger> logger, int threads, int callsPerThread) {
+    const std::string message = "Filtered out";
+    std::vector<std::thread> callers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        callers.emplace_back([logger, &message, callsPerThread] {
+            for (int i = 0; i < callsPerThread; ++i) {
+                logger->debug(message);
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(threads) * callsPerThread / elapsed.count() / 1e6;
+}
+
+// ns per iteration of a small arithmetic loop that also does `logStatement(i)`
+template<typename LogStatement>
+double nsPerIteration(int iterations, LogStatement logStatement) {
+    unsigned long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        checksum += (static_cast<unsigned long long>(i) * 2654435761u) >> 7;
+        logStatement(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    volatile unsigned long long keep = checksum;    // keeps the loop from being optimized away
+    (void)keep;
+    return elapsed.count() / iterations;
+}
+
 int main() {
     std::cout << "=== Logging System Demo ===" << std::endl << std::endl;
     
@@ -66,6 +198,73 @@ int main() {
     logger2->error("This is an ERROR message");
     logger2->fatal("This is a FATAL message");
     
+    // 5. Demonstrate Decorator Pattern: AsyncAppender in front of the file
+    std::cout << "\n\n--- Async Appender ---" << std::endl;
+    const int messages = 100000;
+    auto benchFile = std::make_shared<FileAppender>("bench_logs.txt");
+    auto syncLogger = Logger::getInstance(LogLevel::INFO, benchFile);
+    std::cout << "FileAppender:              " << nsPerLog(syncLogger, messages) << " ns per log" << std::endl;
+
+    // Drop (default) never waits on the file; Block loses nothing but waits once the queue is full
+    for (AsyncOverflowPolicy overflow : { AsyncOverflowPolicy::Drop, AsyncOverflowPolicy::Block }) {
+        AsyncAppenderOptions options;
+        options.overflow = overflow;
+        auto asyncFile = std::make_shared<AsyncAppender>(benchFile, options);
+        auto asyncLogger = Logger::getInstance(LogLevel::INFO, asyncFile);
+        std::cout << (overflow == AsyncOverflowPolicy::Drop ? "AsyncAppender(File) drop:  " : "AsyncAppender(File) block: ")
+                  << nsPerLog(asyncLogger, messages) << " ns per log" << std::endl;
+        asyncFile->flush();
+
+        AsyncAppenderStats stats = asyncFile->getStats();
+        std::cout << "  written " << stats.written << " in " << stats.batches << " batches, dropped " << stats.dropped
+                  << ", max queue depth " << stats.maxQueueDepth << std::endl;
+    }
+    
+    // 6. Level filtering never takes a lock, so disabled calls scale with threads
+    std::cout << "\n\n--- Disabled DEBUG calls (INFO logger) ---" << std::endl;
+    auto infoLogger = Logger::getInstance(LogLevel::INFO, consoleAppender);
+    std::cout << "hardware_concurrency = " << std::thread::hardware_concurrency() << std::endl;
+    for (int threads : { 1, 2, 4, 8 }) {
+        double perSec = disabledCallsPerSec(infoLogger, threads, 50000000);
+        std::cout << threads << " thread(s): " << perSec << " M calls/s in total, "
+                  << 1000.0 / perSec << " ns per call" << std::endl;
+    }
+    
+    // 7. DEBUG disabled in a hot loop: eager strings vs lazy and compiled-out forms
+    std::cout << "\n\n--- Hot loop, DEBUG disabled (ns per iteration) ---" << std::endl;
+    const int iterations = 20000000;
+    std::cout << "no logging:                       "
+              << nsPerIteration(iterations, [](int) {}) << std::endl;
+    std::cout << "logAt<DEBUG> with INFO minimum:   "
+              << nsPerIteration(iterations, [&](int i) {
+                     logAt<LogLevel::DEBUG, static_cast<int>(LogLevel::INFO)>(*infoLogger, [&] { return "i=" + std::to_string(i); });
+                 }) << std::endl;
+    std::cout << "debug(\"i=\" + to_string(i)):       "
+              << nsPerIteration(iterations, [&](int i) { infoLogger->debug("i=" + std::to_string(i)); }) << std::endl;
+    std::cout << "logLazy(DEBUG, lambda):           "
+              << nsPerIteration(iterations, [&](int i) {
+                     infoLogger->logLazy(LogLevel::DEBUG, [&] { return "i=" + std::to_string(i); });
+                 }) << std::endl;
+    std::cout << "LOG_DEBUG(logger, ...):           "
+              << nsPerIteration(iterations, [&](int i) { LOG_DEBUG(infoLogger, "i=" + std::to_string(i)); }) << std::endl;
+
+    // 8. The handler chain is flattened into a per-level table, so its length does not matter
+    std::cout << "\n\n--- Handler chain depth (ns per INFO message, one handler matches) ---" << std::endl;
+    for (int depth : { 1, 4, 16, 64 }) {
+        std::cout << "depth " << depth << ": " << nsPerChainMessage(depth, 2000000) << std::endl;
+    }
+
+    // 9. Binary records vs text lines (decode with MultiThreading/ConcurrentLogger's log_decoder)
+    std::cout << "\n\n--- Text vs binary file appender ---" << std::endl;
+    std::vector<LogMessage> sample;
+    for (int i = 0; i < 200000; ++i) {
+        sample.emplace_back(i % 10 == 0 ? LogLevel::WARNING : LogLevel::INFO, "Request " + std::to_string(i) + " served");
+    }
+    measureSink("FileAppender:       ", "bench_logs.txt", sample);
+    measureSink("BinaryFileAppender: ", "bench_logs.bin", sample);
+    std::cout << "Round trip: " << roundTrip("bench_logs.bin", sample) << " of " << sample.size()
+              << " binary records read back unchanged" << std::endl;
+    
     std::cout << "\n=== Demo Complete ===" << std::endl;
     
     return 0;
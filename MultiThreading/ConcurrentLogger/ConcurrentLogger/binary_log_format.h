@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Binary log format (LogEncoding::Binary), read back by log_decoder.cpp.
+
+    A file is a sequence of entries, each starting with a tag byte:
+
+      HeaderTag  "CLOG" version          start of a run or segment: forget all
+                                         format ids and the last timestamp
+      FormatTag  id fmtLen fmt sigLen sig
+                                         defines a format id: the format string
+                                         and its argument signature, two chars
+                                         per argument (b1 bool, c1 char, iN / uN
+                                         N-byte integer, fN N-byte float, s0 string)
+      RecordTag  tsDelta level formatId argsLen args
+                                         one line: timestamp in ns since the epoch
+                                         as a zigzag delta to the previous record,
+                                         level byte (0 = none, 1..5 = DEBUG..FATAL),
+                                         then the arguments' raw bytes as log()
+                                         copied them (strings: 32-bit length + text)
+
+    All integers in the entry headers are LEB128 varints. Format id 0 is
+    predefined as "{}" with signature "s0": a line logged as finished text.
+    0x00 bytes where a tag should be are skipped: zero padding that a
+    crash left at the end of a pre-sized segment.
+*/
+namespace binlog {
+    constexpr unsigned char HeaderTag = 0xB0;
+    constexpr unsigned char FormatTag = 0xB1;
+    constexpr unsigned char RecordTag = 0xB2;
+    constexpr unsigned char Version = 1;
+    constexpr uint32_t TextFormatId = 0;
+
+    inline void appendVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    // Small negative deltas stay small: 0, -1, 1, -2 ... -> 0, 1, 2, 3 ...
+    inline uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // False if the varint runs past end (a torn last entry)
+    inline bool readVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            unsigned char byte = *p++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return true;
+        }
+        return false;
+    }
+
+    inline void appendHeader(std::string& out) {
+        out.push_back(static_cast<char>(HeaderTag));
+        out.append("CLOG");
+        out.push_back(static_cast<char>(Version));
+    }
+}
@@ -1,9 +1,82 @@
 #include "concurrent_logger.h"
+#include "binary_log_format.h"
+#include <algorithm>
+#include <utility>
+#include <cstdio>
 
-ConcurrentLogger::ConcurrentLogger(const std::string& file, size_t capacity)
-    : maxSize(capacity), running(true)
+namespace {
+    std::atomic<uint64_t> nextLoggerId{ 1 };
+
+    // The staging rings of the current thread, one per logger it has logged to
+    struct ThreadRings {
+        std::vector<std::pair<uint64_t, std::shared_ptr<LogStagingRing>>> rings;
+
+        ~ThreadRings() {
+            for (auto& entry : rings)
+                entry.second->producerExited = true;
+        }
+    };
+
+    thread_local ThreadRings threadRings;
+}
+
+namespace logdetail {
+    const char* appendLiteral(std::string& out, const char* fmt) {
+        const char* hole = std::strstr(fmt, "{}");
+        if (!hole) {
+            out.append(fmt);
+            return fmt + std::strlen(fmt);
+        }
+        out.append(fmt, hole);
+        return hole + 2;
+    }
+
+    void appendValue(std::string& out, bool value) { out.append(value ? "true" : "false"); }
+    void appendValue(std::string& out, char value) { out.push_back(value); }
+
+    void appendValue(std::string& out, long long value) {
+        char digits[32];
+        int n = std::snprintf(digits, sizeof(digits), "%lld", value);
+        out.append(digits, static_cast<size_t>(n));
+    }
+
+    void appendValue(std::string& out, unsigned long long value) {
+        char digits[32];
+        int n = std::snprintf(digits, sizeof(digits), "%llu", value);
+        out.append(digits, static_cast<size_t>(n));
+    }
+
+    void appendValue(std::string& out, double value) {
+        char digits[32];
+        int n = std::snprintf(digits, sizeof(digits), "%g", value);
+        out.append(digits, static_cast<size_t>(n));
+    }
+}
+
+LogStagingRing::LogStagingRing(size_t capacity)
+    : head(0), cachedTail(0), tail(0), producerExited(false), loggerStopped(false)
+{
+    size_t rounded = 1;
+    while (rounded < capacity)
+        rounded <<= 1;
+    slots.resize(rounded);
+    mask = rounded - 1;
+}
+
+ConcurrentLogger::ConcurrentLogger(const std::string& file, size_t capacity, FlushPolicy policy,
+                                   OverflowPolicy overflow, LogEncoding encoding)
+    : ConcurrentLogger(std::unique_ptr<LogOutput>(new StreamLogOutput(file)), capacity, policy, overflow, encoding)
+{
+}
+
+ConcurrentLogger::ConcurrentLogger(std::unique_ptr<LogOutput> output, size_t capacity, FlushPolicy policy,
+                                   OverflowPolicy overflow, LogEncoding encoding)
+    : out(std::move(output)), flushPolicy(policy), overflowPolicy(overflow), encoding(encoding),
+      maxSize(capacity > 0 ? capacity : 1), id(nextLoggerId.fetch_add(1)), ringsVersion(0), lastTimestamp(0),
+      workerSleeping(false), blockedProducers(0), droppedLines(0), running(true)
 {
-    out.open(file, std::ios::app);
+    startSegment();
+    writeOut(writing.size());
     worker = std::thread(&ConcurrentLogger::process, this); //only single consumer thread
     //the logger must be ready BEFORE any producer can log.
 }
@@ -13,42 +86,332 @@ ConcurrentLogger::~ConcurrentLogger() {
 }
 
 void ConcurrentLogger::log(const std::string& msg) {
-    std::unique_lock<std::mutex> lock(mtx);
+    LogStagingRing* ring;
+    LogRecord* record = beginRecord(ring);
+    if (!record)
+        return;
 
-    // wait if buffer full
-    while (buffer.size() >= maxSize && running) {
-        cv.wait(lock);
+    record->format = nullptr;
+    record->signature = nullptr;
+    record->text.assign(msg);
+    commitRecord(*ring);
+}
+
+LogRecord* ConcurrentLogger::beginRecord(LogStagingRing*& ring) {
+    if (!running.load(std::memory_order_relaxed))
+        return nullptr;
+
+    // No lock and no shared counter: the line goes into this thread's own ring
+    ring = &ringForThisThread();
+    size_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->cachedTail > ring->mask) {
+        ring->cachedTail = ring->tail.load(std::memory_order_acquire);
+        if (head - ring->cachedTail > ring->mask && !waitForRoom(*ring, head))
+            return nullptr;
+    }
+    LogRecord* record = &ring->slots[head & ring->mask];
+    if (encoding == LogEncoding::Binary) {
+        record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    return record;
+}
+
+void ConcurrentLogger::commitRecord(LogStagingRing& ring) {
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    // Pairs with the fence in process(): either the worker sees this line
+    // before it sleeps, or we see it asleep and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (workerSleeping.load(std::memory_order_relaxed))
+        wakeWorker();
+}
+
+LogStagingRing& ConcurrentLogger::ringForThisThread() {
+    auto& mine = threadRings.rings;
+    for (auto& entry : mine) {
+        if (entry.first == id)
+            return *entry.second;
     }
 
-    buffer.push(msg);
-    cv.notify_one();   // wake consumer
+    // First line from this thread: forget rings of stopped loggers, register a new one
+    mine.erase(std::remove_if(mine.begin(), mine.end(),
+                              [](const std::pair<uint64_t, std::shared_ptr<LogStagingRing>>& entry) {
+                                  return entry.second->loggerStopped.load();
+                              }),
+               mine.end());
+
+    auto ring = std::make_shared<LogStagingRing>(maxSize);
+    {
+        std::lock_guard<std::mutex> lock(ringsMtx);
+        rings.push_back(ring);
+        ringsVersion.fetch_add(1);
+    }
+    mine.emplace_back(id, ring);
+    return *ring;
+}
+
+bool ConcurrentLogger::waitForRoom(LogStagingRing& ring, size_t head) {
+    switch (overflowPolicy) {
+    case OverflowPolicy::DropNewest:
+        droppedLines.fetch_add(1, std::memory_order_relaxed);
+        return false;
+
+    case OverflowPolicy::DropOldest: {
+        // The worker holds dropMtx while it reads a ring, so the slot we
+        // free here is not being written out at the same time
+        std::lock_guard<std::mutex> lock(ring.dropMtx);
+        size_t tail = ring.tail.load(std::memory_order_relaxed);
+        if (head - tail > ring.mask) {
+            ring.tail.store(tail + 1, std::memory_order_release);
+            droppedLines.fetch_add(1, std::memory_order_relaxed);
+        }
+        ring.cachedTail = ring.tail.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    case OverflowPolicy::Block:
+    default: {
+        blockedProducers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeWorker();
+
+        std::unique_lock<std::mutex> lock(mtx);
+        // wait if buffer full (the timeout only guards against a missed notify)
+        while (running && head - ring.tail.load(std::memory_order_acquire) > ring.mask) {
+            notFull.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        blockedProducers.fetch_sub(1);
+
+        ring.cachedTail = ring.tail.load(std::memory_order_acquire);
+        return head - ring.cachedTail <= ring.mask;
+    }
+    }
+}
+
+void ConcurrentLogger::wakeWorker() {
+    if (workerSleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_one();
+    }
 }
 
 void ConcurrentLogger::stop() {
-    running = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
     cv.notify_all();
+    notFull.notify_all();
     if (worker.joinable())
         worker.join();
-    out.close();
+    out.reset();        // closes the file (or the last segment)
+
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    for (auto& ring : rings)
+        ring->loggerStopped = true;
+}
+
+size_t ConcurrentLogger::drainRings(const std::vector<std::shared_ptr<LogStagingRing>>& snapshot, size_t& written) {
+    size_t lines = 0;
+    size_t room = out->segmentRoom();
+
+    // Round-robin: every ring hands over everything it holds, then the next one
+    for (const auto& ring : snapshot) {
+        std::unique_lock<std::mutex> lock(ring->dropMtx, std::defer_lock);
+        if (overflowPolicy == OverflowPolicy::DropOldest)
+            lock.lock();
+
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        if (head == tail)
+            continue;
+
+        for (size_t i = tail; i != head; ++i) {
+            const LogRecord& record = ring->slots[i & ring->mask];
+            size_t entryStart = writing.size();
+            appendEntry(record);
+
+            if (writing.size() > room) {
+                // The output's segment ends before this line: hand over the
+                // lines that fit; this one starts the next segment, encoded
+                // again after the segment's own header
+                writing.resize(entryStart);
+                written += writeOut(entryStart);
+                startSegment();
+                appendEntry(record);
+                written += writeOut(writing.size());
+                room = out->segmentRoom();
+            }
+        }
+        ring->tail.store(head, std::memory_order_release);
+        lines += head - tail;
+    }
+    return lines;
+}
+
+void ConcurrentLogger::appendEntry(const LogRecord& record) {
+    if (encoding == LogEncoding::Binary) {
+        encodeRecord(record);
+        return;
+    }
+    if (record.format) {
+        const unsigned char* args = record.argsInText
+            ? reinterpret_cast<const unsigned char*>(record.text.data())
+            : record.args;
+        record.format(writing, record.fmt, args);
+    } else {
+        writing.append(record.text);
+    }
+    writing.push_back('\n');
+}
+
+// Binary encoding: the output's file or each of its segments opens with a
+// header, after which the decoder knows no format ids, so they are defined
+// again and the timestamps restart from an absolute one
+void ConcurrentLogger::startSegment() {
+    if (encoding != LogEncoding::Binary)
+        return;
+    binlog::appendHeader(writing);
+    formatIds.clear();
+    lastTimestamp = 0;
+}
+
+// Writes the first bytes of `writing` and drops them from it
+size_t ConcurrentLogger::writeOut(size_t bytes) {
+    if (bytes > 0) {
+        out->write(writing.data(), bytes);
+        writing.erase(0, bytes);    // keeps its capacity for the next pass
+    }
+    return bytes;
+}
+
+void ConcurrentLogger::encodeRecord(const LogRecord& record) {
+    uint32_t formatId = binlog::TextFormatId;
+    if (record.format) {
+        auto found = formatIds.find(std::make_pair(record.fmt, record.signature));
+        if (found == formatIds.end()) {
+            // First use of this format: define it in the stream once
+            formatId = static_cast<uint32_t>(formatIds.size() + 1);
+            formatIds.emplace(std::make_pair(record.fmt, record.signature), formatId);
+            const char* signature = record.signature();
+            writing.push_back(static_cast<char>(binlog::FormatTag));
+            binlog::appendVarint(writing, formatId);
+            binlog::appendVarint(writing, std::strlen(record.fmt));
+            writing.append(record.fmt);
+            binlog::appendVarint(writing, std::strlen(signature));
+            writing.append(signature);
+        } else {
+            formatId = found->second;
+        }
+    }
+
+    writing.push_back(static_cast<char>(binlog::RecordTag));
+    binlog::appendVarint(writing, binlog::zigzag(record.timestamp - lastTimestamp));
+    lastTimestamp = record.timestamp;
+    writing.push_back(0);   // no levels in this logger
+    binlog::appendVarint(writing, formatId);
+
+    if (record.format) {
+        binlog::appendVarint(writing, record.argBytes);
+        if (record.argsInText)
+            writing.append(record.text);
+        else
+            writing.append(reinterpret_cast<const char*>(record.args), record.argBytes);
+    } else {
+        // Finished text travels as format 0's single string argument
+        uint32_t length = static_cast<uint32_t>(record.text.size());
+        binlog::appendVarint(writing, sizeof(length) + length);
+        writing.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        writing.append(record.text);
+    }
+}
+
+void ConcurrentLogger::retireExitedRings() {
+    std::lock_guard<std::mutex> lock(ringsMtx);
+    size_t before = rings.size();
+    rings.erase(std::remove_if(rings.begin(), rings.end(),
+                               [](const std::shared_ptr<LogStagingRing>& ring) {
+                                   return ring->producerExited.load()
+                                       && ring->head.load(std::memory_order_acquire) == ring->tail.load(std::memory_order_relaxed);
+                               }),
+                rings.end());
+    if (rings.size() != before)
+        ringsVersion.fetch_add(1);
 }
 
 void ConcurrentLogger::process() {
+    using Clock = std::chrono::steady_clock;
+    size_t unflushed = 0;
+    Clock::time_point oldestUnflushed;
+
+    std::vector<std::shared_ptr<LogStagingRing>> snapshot;
+    size_t snapshotVersion = 0;
+    bool haveSnapshot = false;
+    size_t passes = 0;
+
     while (true) {
-        std::unique_lock<std::mutex> lock(mtx);
+        if (!haveSnapshot || ringsVersion.load() != snapshotVersion) {
+            std::lock_guard<std::mutex> lock(ringsMtx);
+            snapshot = rings;
+            snapshotVersion = ringsVersion.load();
+            haveSnapshot = true;
+        }
+
+        // Read before draining: once stopping, a pass that finds nothing is the last
+        bool stopping = !running.load();
+        size_t written = 0;
+        size_t lines = drainRings(snapshot, written);
+
+        if (lines > 0) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (blockedProducers.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> lock(mtx);
+                notFull.notify_all();   // wake producers
+            }
+
+            written += writeOut(writing.size());
+            if (unflushed == 0)
+                oldestUnflushed = Clock::now();
+            unflushed += written;
+        }
 
-        // wait if buffer empty
-        while (buffer.empty() && running) {
-            cv.wait(lock);
+        if (unflushed > 0 && (unflushed >= flushPolicy.maxUnflushedBytes
+                              || Clock::now() - oldestUnflushed >= flushPolicy.maxDelay)) {
+            out->flush();
+            unflushed = 0;
         }
 
-        if (!running && buffer.empty())
+        if (++passes % 256 == 0)
+            retireExitedRings();
+        if (lines > 0)
+            continue;
+        if (stopping)
             break;
 
-        std::string msg = buffer.front();
-        buffer.pop();
-        cv.notify_one();   // wake producer
+        retireExitedRings();
 
-        lock.unlock();
-        out << msg << std::endl;
+        // Nothing anywhere: announce we are going to sleep, then look once more
+        workerSleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool idle = ringsVersion.load() == snapshotVersion;
+        for (const auto& ring : snapshot) {
+            if (ring->head.load(std::memory_order_acquire) != ring->tail.load(std::memory_order_relaxed))
+                idle = false;
+        }
+        if (!idle) {
+            workerSleeping = false;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mtx);
+        auto woken = [this] { return !workerSleeping.load() || !running.load(); };
+        if (unflushed == 0)
+            cv.wait(lock, woken);
+        else
+            cv.wait_until(lock, oldestUnflushed + flushPolicy.maxDelay, woken);
+        workerSleeping = false;
     }
+
+    out->flush();
 }
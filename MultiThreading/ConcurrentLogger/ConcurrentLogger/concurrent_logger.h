@@ -1,29 +1,303 @@
 #pragma once
 #include <iostream>
-#include <fstream>
+#include "log_output.h"
 #include <thread>
 #include <mutex>
-#include <queue>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
 #include <condition_variable>
 #include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+// When the worker pushes written data from its LogOutput to the OS
+struct FlushPolicy {
+    size_t maxUnflushedBytes = 64 * 1024;                   // flush once this much was written...
+    std::chrono::milliseconds maxDelay{ 100 };              // ...or once the oldest unflushed line is this old
+};
+
+// What log() does when the calling thread's staging ring is full
+enum class OverflowPolicy {
+    Block,          // wait for the worker to make room (nothing is lost)
+    DropNewest,     // discard the line being logged
+    DropOldest      // discard the oldest line still waiting in the ring
+};
+
+// What the worker writes for each line
+enum class LogEncoding {
+    Text,           // the formatted line and '\n'
+    Binary          // a compact record, see binary_log_format.h; read it back with log_decoder
+};
+
+namespace logdetail {
+    // Turns one record's raw argument bytes back into text, on the worker
+    using FormatFn = void (*)(std::string& out, const char* fmt, const unsigned char* args);
+
+    // The argument types of a record, for the binary format's format table
+    using SignatureFn = const char* (*)();
+
+    // Appends fmt up to the next "{}" and returns where to continue after it
+    const char* appendLiteral(std::string& out, const char* fmt);
+
+    void appendValue(std::string& out, bool value);
+    void appendValue(std::string& out, char value);
+    void appendValue(std::string& out, long long value);
+    void appendValue(std::string& out, unsigned long long value);
+    void appendValue(std::string& out, double value);
+
+    // How an argument is stored in a record: numbers as their raw bytes,
+    // strings as a 32-bit length followed by the characters
+    template<typename T, typename Enable = void>
+    struct ArgCodec {
+        static_assert(sizeof(T) == 0, "log(fmt, args...) takes numbers, bool, char and strings");
+    };
+
+    template<typename T>
+    struct ArgCodec<T, std::enable_if_t<std::is_arithmetic<T>::value>> {
+        // The signature stores the size as one digit, and log_decoder reads 1/2/4/8-byte values only
+        static_assert(sizeof(T) <= 8, "long double has no portable record layout; log it as double");
+
+        static size_t size(const T&) { return sizeof(T); }
+
+        static void signature(std::string& out) {
+            out.push_back(std::is_same<T, bool>::value ? 'b'
+                        : std::is_same<T, char>::value ? 'c'
+                        : std::is_floating_point<T>::value ? 'f'
+                        : std::is_signed<T>::value ? 'i' : 'u');
+            out.push_back(static_cast<char>('0' + sizeof(T)));
+        }
+
+        static unsigned char* encode(unsigned char* dst, const T& value) {
+            std::memcpy(dst, &value, sizeof(T));
+            return dst + sizeof(T);
+        }
+
+        static const unsigned char* decode(std::string& out, const unsigned char* src) {
+            T value;
+            std::memcpy(&value, src, sizeof(T));
+            using Printed = std::conditional_t<std::is_same<T, bool>::value || std::is_same<T, char>::value, T,
+                            std::conditional_t<std::is_floating_point<T>::value, double,
+                            std::conditional_t<std::is_signed<T>::value, long long, unsigned long long>>>;
+            appendValue(out, static_cast<Printed>(value));
+            return src + sizeof(T);
+        }
+    };
+
+    struct StringCodec {
+        static size_t size(const char* text, size_t length) { (void)text; return sizeof(uint32_t) + length; }
+        static void signature(std::string& out) { out.append("s0"); }
+
+        static unsigned char* encode(unsigned char* dst, const char* text, size_t length) {
+            uint32_t n = static_cast<uint32_t>(length);
+            std::memcpy(dst, &n, sizeof(n));
+            std::memcpy(dst + sizeof(n), text, length);
+            return dst + sizeof(n) + length;
+        }
+
+        static const unsigned char* decode(std::string& out, const unsigned char* src) {
+            uint32_t n;
+            std::memcpy(&n, src, sizeof(n));
+            out.append(reinterpret_cast<const char*>(src + sizeof(n)), n);
+            return src + sizeof(n) + n;
+        }
+    };
+
+    template<>
+    struct ArgCodec<const char*> : StringCodec {
+        static size_t size(const char* s) { return StringCodec::size(s, std::strlen(s)); }
+        static unsigned char* encode(unsigned char* dst, const char* s) { return StringCodec::encode(dst, s, std::strlen(s)); }
+    };
+
+    template<>
+    struct ArgCodec<char*> : ArgCodec<const char*> {};
+
+    template<>
+    struct ArgCodec<std::string> : StringCodec {
+        static size_t size(const std::string& s) { return StringCodec::size(s.data(), s.size()); }
+        static unsigned char* encode(unsigned char* dst, const std::string& s) { return StringCodec::encode(dst, s.data(), s.size()); }
+    };
+
+    template<typename... Args>
+    void formatRecord(std::string& out, const char* fmt, const unsigned char* args) {
+        // Each argument replaces the next "{}", in order
+        using expand = int[];
+        (void)expand{ 0, (fmt = appendLiteral(out, fmt), args = ArgCodec<Args>::decode(out, args), 0)... };
+        (void)args;
+        out.append(fmt);
+    }
+
+    template<typename... Args>
+    const char* argSignature() {
+        static const std::string signature = [] {
+            std::string s;
+            using expand = int[];
+            (void)expand{ 0, (ArgCodec<Args>::signature(s), 0)... };
+            return s;
+        }();
+        return signature.c_str();
+    }
+}
+
+// One line waiting in a staging ring: either finished text, or a format
+// string and the raw bytes of its arguments for the worker to format
+struct LogRecord {
+    static constexpr size_t InlineArgBytes = 48;
+
+    logdetail::FormatFn format = nullptr;   // null: text is the finished line
+    logdetail::SignatureFn signature = nullptr;
+    const char* fmt = nullptr;
+    bool argsInText = false;                // arguments too big for `args` are in `text`
+    size_t argBytes = 0;
+    int64_t timestamp = 0;                  // ns since the epoch; LogEncoding::Binary only
+    unsigned char args[InlineArgBytes];
+    std::string text;
+};
+
+/*
+    Staging ring owned by one producer thread: single producer, single
+    consumer (the worker). Slots are records whose text keeps its capacity,
+    so once a slot has held a line that long, logging into it does not allocate.
+    head is only written by the producer, tail by the worker; each sits on
+    its own cache line.
+*/
+struct LogStagingRing {
+    explicit LogStagingRing(size_t capacity);
+
+    static constexpr size_t CacheLine = 64;
+
+    std::vector<LogRecord> slots;
+    size_t mask;
+
+    alignas(CacheLine) std::atomic<size_t> head;     // next slot to fill (producer)
+    size_t cachedTail;                               // producer's last look at tail
+
+    alignas(CacheLine) std::atomic<size_t> tail;     // next slot to write out (worker)
+
+    // Only with OverflowPolicy::DropOldest: lets the producer advance tail.
+    // The worker takes it once per pass, never per line.
+    std::mutex dropMtx;
+
+    std::atomic<bool> producerExited;   // set at thread exit; the worker retires the ring once empty
+    std::atomic<bool> loggerStopped;    // set by stop(); the thread forgets the ring on its next registration
+};
 
 class ConcurrentLogger {
 public:
-    ConcurrentLogger(const std::string& file, size_t capacity = 1024);
+    // capacity is per producer thread: lines that may wait in its staging ring
+    ConcurrentLogger(const std::string& file, size_t capacity = 1024, FlushPolicy policy = FlushPolicy(),
+                     OverflowPolicy overflow = OverflowPolicy::Block, LogEncoding encoding = LogEncoding::Text);
+    // Same, writing to any output (e.g. a MappedLogOutput); the logger owns it
+    ConcurrentLogger(std::unique_ptr<LogOutput> output, size_t capacity = 1024, FlushPolicy policy = FlushPolicy(),
+                     OverflowPolicy overflow = OverflowPolicy::Block, LogEncoding encoding = LogEncoding::Text);
     ~ConcurrentLogger();
 
     void log(const std::string& msg);
+
+    /*
+        Deferred formatting: log("T{} -> msg {}", id, j) copies only the
+        format pointer and the arguments' bytes into the ring; the worker
+        thread builds the text. Each "{}" takes the next argument (numbers,
+        bool, char, C strings, std::string). fmt itself is NOT copied, so
+        it must stay valid until the logger stops - a string literal.
+        At least one argument is required: log(buffer) with a plain char
+        array or c_str() must still copy its text, and does so through
+        log(const std::string&).
+    */
+    template<typename Arg, typename... Rest>
+    void log(const char* fmt, const Arg& first, const Rest&... rest) {
+        logDeferred(fmt, first, rest...);
+    }
+
     void stop();
 
+    // Lines discarded by DropNewest / DropOldest so far
+    size_t dropped() const { return droppedLines.load(); }
+
 private:
+    template<typename... Args>
+    void logDeferred(const char* fmt, const Args&... args) {
+        LogStagingRing* ring;
+        LogRecord* record = beginRecord(ring);
+        if (!record)
+            return;
+
+        size_t bytes = 0;
+        using expand = int[];
+        (void)expand{ 0, (bytes += logdetail::ArgCodec<std::decay_t<Args>>::size(args), 0)... };
+
+        unsigned char* dst = record->args;
+        record->argBytes = bytes;
+        record->argsInText = bytes > LogRecord::InlineArgBytes;
+        if (record->argsInText) {
+            record->text.resize(bytes);
+            dst = reinterpret_cast<unsigned char*>(&record->text[0]);
+        }
+        (void)expand{ 0, (dst = logdetail::ArgCodec<std::decay_t<Args>>::encode(dst, args), 0)... };
+        (void)dst;
+
+        record->format = &logdetail::formatRecord<std::decay_t<Args>...>;
+        record->signature = &logdetail::argSignature<std::decay_t<Args>...>;
+        record->fmt = fmt;
+        commitRecord(*ring);
+    }
+
     void process();
 
-    std::ofstream out;
-    std::queue<std::string> buffer;
+    // log() is beginRecord, fill the slot, commitRecord. beginRecord returns
+    // null when the line is to be dropped (stopped, or ring full with DropNewest).
+    LogRecord* beginRecord(LogStagingRing*& ring);
+    void commitRecord(LogStagingRing& ring);
+    LogStagingRing& ringForThisThread();
+    bool waitForRoom(LogStagingRing& ring, size_t head);
+    size_t drainRings(const std::vector<std::shared_ptr<LogStagingRing>>& snapshot, size_t& written);
+    size_t writeOut(size_t bytes);
+    void appendEntry(const LogRecord& record);
+    void startSegment();
+    void retireExitedRings();
+    void wakeWorker();
+    void encodeRecord(const LogRecord& record);
+
+    std::unique_ptr<LogOutput> out;
+    FlushPolicy flushPolicy;
+    OverflowPolicy overflowPolicy;
+    const LogEncoding encoding;
     size_t maxSize;
+    const uint64_t id;              // tells this logger's rings apart in a thread's cache
+
+    // Every producer thread's ring. Registration (once per thread) and
+    // retirement take ringsMtx; the worker re-copies the list only when
+    // ringsVersion moved.
+    std::mutex ringsMtx;
+    std::vector<std::shared_ptr<LogStagingRing>> rings;
+    std::atomic<size_t> ringsVersion;
+
+    // The worker appends every line it takes to this buffer and writes it in
+    // one call - or in two where the output's current segment ends
+    std::string writing;
 
+    // Binary encoding, worker only: format ids handed out in the current
+    // segment, keyed by (format string, argument types), and the last
+    // record's timestamp
+    struct FormatKeyHash {
+        size_t operator()(const std::pair<const char*, logdetail::SignatureFn>& key) const {
+            return std::hash<const void*>()(key.first) ^ (std::hash<const void*>()(reinterpret_cast<const void*>(key.second)) << 1);
+        }
+    };
+    std::unordered_map<std::pair<const char*, logdetail::SignatureFn>, uint32_t, FormatKeyHash> formatIds;
+    int64_t lastTimestamp;
+
+    // Slow paths only: the worker sleeping with nothing to do, producers blocked on a full ring
     std::mutex mtx;
     std::condition_variable cv;
+    std::condition_variable notFull;
+    std::atomic<bool> workerSleeping;
+    std::atomic<size_t> blockedProducers;
+
+    std::atomic<size_t> droppedLines;
     std::atomic<bool> running;
     std::thread worker;
 };
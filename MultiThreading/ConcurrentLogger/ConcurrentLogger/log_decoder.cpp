@@ -0,0 +1,344 @@
+#include "binary_log_format.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+/*
+    Standalone tool (own main, excluded from the default build): turns
+    binary logs (ConcurrentLogger with LogEncoding::Binary, Logger's
+    BinaryFileAppender) back into text lines or JSON.
+
+        log_decoder [--json] [--grep TEXT] [file ...]
+
+    Files are read as one stream in the order given (stdin without any),
+    so the segments of a MappedLogOutput decode as "app.log.1 app.log.2 ..."
+    and compressed ones through "zcat app.log.*.gz | log_decoder". Each
+    segment starts with a header, so any one of them also decodes alone.
+    --grep keeps only lines whose message contains TEXT.
+
+    g++ -std=c++17 -O2 log_decoder.cpp -o log_decoder
+*/
+
+namespace {
+    struct Format {
+        std::string fmt;
+        std::string signature;
+    };
+
+    const char* levelName(unsigned level) {
+        static const char* names[] = { nullptr, "DEBUG", "INFO", "WARNING", "ERROR", "FATAL" };
+        return level < 6 ? names[level] : "UNKNOWN";
+    }
+
+    void appendJsonString(std::string& out, const char* text, size_t length) {
+        out.push_back('"');
+        for (size_t i = 0; i < length; ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (c < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out.append(escaped);
+                } else {
+                    out.push_back(static_cast<char>(c));
+                }
+            }
+        }
+        out.push_back('"');
+    }
+
+    template<typename T>
+    T readRaw(const unsigned char* p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    // Whether kind/size is a signature pair the logger writes
+    bool knownArg(char kind, char size) {
+        switch (kind) {
+        case 'b':
+        case 'c': return size == '1';
+        case 'i':
+        case 'u': return size == '1' || size == '2' || size == '4' || size == '8';
+        case 'f': return size == '4' || size == '8';
+        case 's': return size == '0';
+        default:  return false;
+        }
+    }
+
+    // Decodes one argument: its text for the message, its JSON value for --json.
+    // Returns how many bytes it used, 0 if it does not fit in [p, end) or its
+    // signature is not one the logger writes.
+    size_t decodeArg(char kind, char size, const unsigned char* p, const unsigned char* end,
+                     std::string& text, std::string& json) {
+        if (!knownArg(kind, size))
+            return 0;
+        size_t bytes = (kind == 's') ? sizeof(uint32_t) : static_cast<size_t>(size - '0');
+        if (static_cast<size_t>(end - p) < bytes)
+            return 0;
+
+        char digits[32];
+        switch (kind) {
+        case 'b':
+            text = p[0] ? "true" : "false";
+            json = text;
+            return 1;
+        case 'c':
+            text.assign(1, static_cast<char>(p[0]));
+            json.clear();
+            appendJsonString(json, text.data(), 1);
+            return 1;
+        case 'i': {
+            long long value = bytes == 1 ? readRaw<int8_t>(p) : bytes == 2 ? readRaw<int16_t>(p)
+                            : bytes == 4 ? readRaw<int32_t>(p) : readRaw<int64_t>(p);
+            std::snprintf(digits, sizeof(digits), "%lld", value);
+            break;
+        }
+        case 'u': {
+            unsigned long long value = bytes == 1 ? readRaw<uint8_t>(p) : bytes == 2 ? readRaw<uint16_t>(p)
+                                     : bytes == 4 ? readRaw<uint32_t>(p) : readRaw<uint64_t>(p);
+            std::snprintf(digits, sizeof(digits), "%llu", value);
+            break;
+        }
+        case 'f': {
+            double value = bytes == 4 ? readRaw<float>(p) : readRaw<double>(p);
+            std::snprintf(digits, sizeof(digits), "%g", value);
+            break;
+        }
+        case 's': {
+            uint32_t length = readRaw<uint32_t>(p);
+            if (static_cast<size_t>(end - p) - bytes < length)
+                return 0;
+            text.assign(reinterpret_cast<const char*>(p + bytes), length);
+            json.clear();
+            appendJsonString(json, text.data(), text.size());
+            return bytes + length;
+        }
+        default:
+            return 0;
+        }
+        text = digits;
+        json = digits;
+        return bytes;
+    }
+
+    std::string formatTime(int64_t ns) {
+        std::time_t seconds = static_cast<std::time_t>(ns / 1000000000);
+        std::tm utc;
+#if defined(_WIN32)
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+        char text[64];
+        size_t n = std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &utc);
+        std::snprintf(text + n, sizeof(text) - n, ".%09lld", static_cast<long long>(ns % 1000000000));
+        return text;
+    }
+
+    class Decoder {
+    public:
+        Decoder(bool json, std::string grep) : json(json), grep(std::move(grep)) { reset(); }
+
+        // Returns false on a corrupt or torn entry; data before it is already printed
+        bool decode(const unsigned char* p, const unsigned char* end) {
+            std::string line;
+            while (p < end) {
+                const unsigned char* entry = p;
+                unsigned char tag = *p++;
+                bool ok;
+                if (tag == 0) {
+                    // Zero padding left in a pre-sized segment by a crash; a new run may follow
+                    while (p < end && *p == 0)
+                        ++p;
+                    continue;
+                }
+                if (tag == binlog::HeaderTag)
+                    ok = readHeader(p, end);
+                else if (tag == binlog::FormatTag)
+                    ok = readFormat(p, end);
+                else if (tag == binlog::RecordTag)
+                    ok = readRecord(p, end, line);
+                else
+                    ok = false;
+
+                if (!ok) {
+                    std::cerr << "log_decoder: bad or incomplete entry at byte " << (entry - start) << std::endl;
+                    return false;
+                }
+                if (!line.empty()) {
+                    std::cout << line << '\n';
+                    line.clear();
+                }
+            }
+            return true;
+        }
+
+        void setStart(const unsigned char* p) { start = p; }
+
+    private:
+        void reset() {
+            formats.clear();
+            formats[binlog::TextFormatId] = Format{ "{}", "s0" };
+            lastTimestamp = 0;
+        }
+
+        bool readHeader(const unsigned char*& p, const unsigned char* end) {
+            if (end - p < 5 || std::memcmp(p, "CLOG", 4) != 0 || p[4] != binlog::Version)
+                return false;
+            p += 5;
+            reset();
+            return true;
+        }
+
+        bool readString(const unsigned char*& p, const unsigned char* end, std::string& out) {
+            uint64_t length;
+            if (!binlog::readVarint(p, end, length) || static_cast<uint64_t>(end - p) < length)
+                return false;
+            out.assign(reinterpret_cast<const char*>(p), static_cast<size_t>(length));
+            p += length;
+            return true;
+        }
+
+        bool readFormat(const unsigned char*& p, const unsigned char* end) {
+            uint64_t id;
+            Format format;
+            if (!binlog::readVarint(p, end, id) || !readString(p, end, format.fmt) || !readString(p, end, format.signature))
+                return false;
+            formats[id] = std::move(format);
+            return true;
+        }
+
+        bool readRecord(const unsigned char*& p, const unsigned char* end, std::string& line) {
+            uint64_t delta, formatId, argsLength;
+            if (!binlog::readVarint(p, end, delta) || p >= end)
+                return false;
+            unsigned level = *p++;
+            if (!binlog::readVarint(p, end, formatId) || !binlog::readVarint(p, end, argsLength)
+                || static_cast<uint64_t>(end - p) < argsLength)
+                return false;
+            const unsigned char* args = p;
+            const unsigned char* argsEnd = p + argsLength;
+            p = argsEnd;
+
+            lastTimestamp += binlog::unzigzag(delta);
+            auto found = formats.find(formatId);
+            if (found == formats.end())
+                return false;
+            const Format& format = found->second;
+
+            // Each argument replaces the next "{}", in order
+            std::string message;
+            std::string jsonArgs;
+            std::string text, value;
+            const char* fmt = format.fmt.c_str();
+            for (size_t i = 0; i + 1 < format.signature.size(); i += 2) {
+                size_t used = decodeArg(format.signature[i], format.signature[i + 1], args, argsEnd, text, value);
+                if (used == 0)
+                    return false;
+                args += used;
+
+                const char* hole = std::strstr(fmt, "{}");
+                if (hole) {
+                    message.append(fmt, hole);
+                    message.append(text);
+                    fmt = hole + 2;
+                }
+                if (!jsonArgs.empty())
+                    jsonArgs.push_back(',');
+                jsonArgs.append(value);
+            }
+            message.append(fmt);
+
+            if (!grep.empty() && message.find(grep) == std::string::npos)
+                return true;
+
+            if (json) {
+                line = "{\"ts\":" + std::to_string(lastTimestamp) + ",\"level\":";
+                if (level == 0) {
+                    line.append("null");
+                } else {
+                    const char* name = levelName(level);
+                    appendJsonString(line, name, std::strlen(name));
+                }
+                line.append(",\"format\":");
+                appendJsonString(line, format.fmt.data(), format.fmt.size());
+                line.append(",\"args\":[" + jsonArgs + "],\"message\":");
+                appendJsonString(line, message.data(), message.size());
+                line.push_back('}');
+            } else {
+                line = formatTime(lastTimestamp);
+                if (level != 0)
+                    line.append(" [").append(levelName(level)).append("]");
+                line.append(" ").append(message);
+            }
+            return true;
+        }
+
+        bool json;
+        std::string grep;
+        std::unordered_map<uint64_t, Format> formats;
+        int64_t lastTimestamp;
+        const unsigned char* start = nullptr;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    std::string grep;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (arg == "--grep" && i + 1 < argc) {
+            grep = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "usage: log_decoder [--json] [--grep TEXT] [file ...]" << std::endl;
+            return 0;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    // Files are read back to back, as one stream
+    std::vector<unsigned char> data;
+    if (files.empty()) {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        data.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    for (const std::string& file : files) {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            std::cerr << "log_decoder: cannot open " << file << std::endl;
+            return 1;
+        }
+        data.insert(data.end(), std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    Decoder decoder(json, grep);
+    decoder.setStart(data.data());
+    bool ok = decoder.decode(data.data(), data.data() + data.size());
+    std::cout << std::flush;
+    return ok ? 0 : 2;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <limits>
+
+/*
+    Where the logger's worker puts its batches. write() always receives
+    whole entries (lines, or records with LogEncoding::Binary). An output
+    that rolls over to a new segment does so only between two write()
+    calls, never inside one, so it never looks into the bytes for a
+    boundary. The worker cuts its batches at segmentRoom() to fill each
+    segment, and so knows which write() opens a new one: with
+    LogEncoding::Binary that write starts with a header and defines its
+    formats again, so every segment decodes on its own. flush() is called
+    as the FlushPolicy says and should hand the data to the OS without
+    waiting for the disk.
+*/
+class LogOutput {
+public:
+    virtual ~LogOutput() = default;
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() = 0;
+
+    // Bytes the next write() may hold and still go into the current segment;
+    // a bigger one starts a new segment. An output without segments never rolls.
+    virtual size_t segmentRoom() const { return std::numeric_limits<size_t>::max(); }
+};
+
+// One file opened in append mode that grows forever
+class StreamLogOutput : public LogOutput {
+public:
+    explicit StreamLogOutput(const std::string& file) : out(file, std::ios::app) {}
+
+    void write(const char* data, size_t size) override { out.write(data, static_cast<std::streamsize>(size)); }
+    void flush() override { out.flush(); }
+
+private:
+    std::ofstream out;
+};
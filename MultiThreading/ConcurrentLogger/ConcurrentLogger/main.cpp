@@ -1,25 +1,233 @@
 #include "concurrent_logger.h"
+#include "mapped_log_output.h"
+#include "binary_log_format.h"
 #include <string>
 #include <vector>
+#include <set>
+#include <chrono>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdio>
 
-void workerThread(int id, ConcurrentLogger* logger)
+struct RunResult {
+    double linesPerSec;
+    double nsPerLog;        // producer loop time per line, waiting on a full ring included
+    size_t dropped;
+};
+
+void workerThread(int id, int messages, ConcurrentLogger* logger, std::atomic<long long>* nsInLog)
 {
-    //producer threads are being created
-    for (int j = 0; j < 20; ++j) {
-        logger->log("T" + std::to_string(id) +
-            " -> msg " + std::to_string(j));
+    //producer threads are being created; the text is built on the logger's worker
+    auto start = std::chrono::steady_clock::now();
+    for (int j = 0; j < messages; ++j) {
+        logger->log("T{} -> msg {}", id, j);
     }
+    *nsInLog += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
-int main()
+// Producer-side cost of one call. The ring is big enough for a whole round
+// and is drained between rounds; the first round (page faults, slot
+// strings growing) is not timed.
+double nsPerCall(bool deferred)
 {
-    ConcurrentLogger logger("app.log", 8);
+    const int rounds = 6;
+    const int perRound = 50000;
+    ConcurrentLogger logger("app.log", 65536);
+
+    double timedNs = 0;
+    for (int round = 0; round < rounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        if (deferred) {
+            for (int j = 0; j < perRound; ++j)
+                logger.log("T{} -> msg {}", 0, j);
+        } else {
+            for (int j = 0; j < perRound; ++j)
+                logger.log("T" + std::to_string(0) + " -> msg " + std::to_string(j));
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (round > 0)
+            timedNs += elapsed.count();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    logger.stop();
+    return timedNs / ((rounds - 1) * perRound);
+}
+
+RunResult run(int producers, int totalMessages, OverflowPolicy overflow)
+{
+    const int messagesPerThread = totalMessages / producers;
+    std::atomic<long long> nsInLog{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+    ConcurrentLogger logger("app.log", 1024, FlushPolicy(), overflow);
 
     std::vector<std::thread> threads;
-    for (int i = 0; i < 4; ++i) {
-        threads.emplace_back(workerThread, i, &logger);
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back(workerThread, i, messagesPerThread, &logger, &nsInLog);
+    }
+
+    for (auto& t : threads) t.join();
+    logger.stop();      // returns once every line is written and flushed
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int logged = producers * messagesPerThread;
+    return RunResult{ logged / elapsed.count(), static_cast<double>(nsInLog.load()) / logged, logger.dropped() };
+}
+
+// Same producers, different output backend
+double linesPerSecTo(std::unique_ptr<LogOutput> output, int producers, int totalMessages)
+{
+    const int messagesPerThread = totalMessages / producers;
+    std::atomic<long long> nsInLog{ 0 };
+
+    auto start = std::chrono::steady_clock::now();
+    ConcurrentLogger logger(std::move(output));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back(workerThread, i, messagesPerThread, &logger, &nsInLog);
     }
 
     for (auto& t : threads) t.join();
     logger.stop();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return producers * messagesPerThread / elapsed.count();
+}
+
+struct EncodingResult {
+    double linesPerSec;
+    double bytesPerLine;
+};
+
+// Same producers writing a fresh file, text lines vs binary records
+EncodingResult runEncoding(LogEncoding encoding, const std::string& file, int producers, int totalMessages)
+{
+    const int messagesPerThread = totalMessages / producers;
+    std::atomic<long long> nsInLog{ 0 };
+    std::remove(file.c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    ConcurrentLogger logger(file, 1024, FlushPolicy(), OverflowPolicy::Block, encoding);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back(workerThread, i, messagesPerThread, &logger, &nsInLog);
+    }
+
+    for (auto& t : threads) t.join();
+    logger.stop();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int logged = producers * messagesPerThread;
+    std::ifstream written(file, std::ios::binary | std::ios::ate);
+    return EncodingResult{ logged / elapsed.count(), static_cast<double>(written.tellg()) / logged };
+}
+
+// Whether one binary segment decodes without the segments before it: it
+// opens with a header and defines every format id its records use
+bool decodesAlone(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(bytes.data());
+    const unsigned char* end = p + bytes.size();
+    if (bytes.size() < 6 || p[0] != binlog::HeaderTag)
+        return false;
+    p += 6;
+
+    std::set<uint64_t> defined{ binlog::TextFormatId };
+    while (p < end) {
+        unsigned char tag = *p++;
+        uint64_t id, length, delta;
+        if (tag == binlog::FormatTag) {
+            if (!binlog::readVarint(p, end, id) || !binlog::readVarint(p, end, length) || static_cast<uint64_t>(end - p) < length)
+                return false;
+            p += length;
+            if (!binlog::readVarint(p, end, length) || static_cast<uint64_t>(end - p) < length)
+                return false;
+            p += length;
+            defined.insert(id);
+        } else if (tag == binlog::RecordTag) {
+            if (!binlog::readVarint(p, end, delta) || p++ >= end)      // timestamp delta, level
+                return false;
+            if (!binlog::readVarint(p, end, id) || !defined.count(id)
+                || !binlog::readVarint(p, end, length) || static_cast<uint64_t>(end - p) < length)
+                return false;
+            p += length;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    const int totalMessages = 400000;
+    const int producerCounts[] = { 1, 2, 4, 8, 16, 32 };
+    const std::pair<OverflowPolicy, const char*> policies[] = {
+        { OverflowPolicy::Block, "block" },
+        { OverflowPolicy::DropNewest, "drop-newest" },
+        { OverflowPolicy::DropOldest, "drop-oldest" },
+    };
+
+    std::cout << "hardware_concurrency = " << std::thread::hardware_concurrency() << "\n\n";
+    std::cout << "Producer cost per line (1 thread, ring never full)\n" << std::fixed << std::setprecision(1)
+              << "  log(\"T\" + to_string(id) + ...)   " << nsPerCall(false) << " ns\n"
+              << "  log(\"T{} -> msg {}\", id, j)       " << nsPerCall(true) << " ns\n\n";
+
+    std::cout << totalMessages << " lines per run, 1024-line ring per producer\n";
+    std::cout << std::left << std::setw(14) << "policy" << std::setw(11) << "producers" << std::right
+              << std::setw(14) << "lines/s" << std::setw(14) << "ns per log" << std::setw(10) << "dropped" << "\n";
+
+    for (const auto& policy : policies) {
+        for (int producers : producerCounts) {
+            RunResult r = run(producers, totalMessages, policy.first);
+            std::cout << std::left << std::setw(14) << policy.second << std::setw(11) << producers << std::right
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(14) << r.linesPerSec << std::setw(14) << r.nsPerLog
+                      << std::setw(10) << r.dropped << std::endl;
+        }
+    }
+
+    // 4 MiB segments, so the mapped run rolls a few times ("app.mapped.log.1", ".2", ...)
+    MappedLogOptions segments;
+    segments.segmentBytes = 4 * 1024 * 1024;
+    int segmentsClosed = 0;
+    segments.onSegmentClosed = [&segmentsClosed](const std::string&) { ++segmentsClosed; };
+
+    std::cout << "\nOutput backend, 4 producers, block (lines/s)\n" << std::fixed << std::setprecision(0)
+              << "  ofstream append       " << linesPerSecTo(std::unique_ptr<LogOutput>(new StreamLogOutput("app.log")), 4, totalMessages) << "\n"
+              << "  mmap segments         " << linesPerSecTo(std::unique_ptr<LogOutput>(new MappedLogOutput("app.mapped.log", segments)), 4, totalMessages);
+    std::cout << "   (" << segmentsClosed << " segments closed)\n";
+
+    // Binary records skip formatting on the worker; log_decoder turns app.bin.log back into text
+    EncodingResult text = runEncoding(LogEncoding::Text, "app.text.log", 4, totalMessages);
+    EncodingResult binary = runEncoding(LogEncoding::Binary, "app.bin.log", 4, totalMessages);
+    std::cout << "\nEncoding, 4 producers, block\n" << std::fixed << std::setprecision(1)
+              << "  text     " << std::setw(12) << std::setprecision(0) << text.linesPerSec << " lines/s  "
+              << std::setprecision(1) << text.bytesPerLine << " bytes/line\n"
+              << "  binary   " << std::setw(12) << std::setprecision(0) << binary.linesPerSec << " lines/s  "
+              << std::setprecision(1) << binary.bytesPerLine << " bytes/line (timestamped)\n";
+
+    // Binary records into 256 KiB segments: every one of them must decode on its own
+    MappedLogOptions small;
+    small.segmentBytes = 256 * 1024;
+    std::vector<std::string> closed;
+    small.onSegmentClosed = [&closed](const std::string& path) { closed.push_back(path); };
+    {
+        ConcurrentLogger logger(std::unique_ptr<LogOutput>(new MappedLogOutput("app.bin.mapped.log", small)), 1024,
+                                FlushPolicy(), OverflowPolicy::Block, LogEncoding::Binary);
+        std::atomic<long long> nsInLog{ 0 };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back(workerThread, i, totalMessages / 4, &logger, &nsInLog);
+        }
+        for (auto& t : threads) t.join();
+    }   // the output's background thread is joined: closed is complete
+    std::cout << "  binary segments that decode alone: "
+              << std::count_if(closed.begin(), closed.end(), decodesAlone) << " of " << closed.size() << "\n";
 }
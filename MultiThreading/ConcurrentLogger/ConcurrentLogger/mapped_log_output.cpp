@@ -0,0 +1,268 @@
+#include "mapped_log_output.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(MAPPED_LOG_WITH_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace {
+    bool fileExists(const std::string& path) {
+        return std::ifstream(path).good();
+    }
+
+    size_t pageSize() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+}
+
+MappedLogOutput::MappedLogOutput(const std::string& basePath, MappedLogOptions options)
+    : basePath(basePath), options(std::move(options)), nextIndex(1), mapping(nullptr), capacity(0), used(0), flushedUpTo(0),
+#if defined(_WIN32)
+      file(nullptr), fileMapping(nullptr),
+#else
+      fd(-1),
+#endif
+      stopping(false)
+{
+    if (this->options.segmentBytes < pageSize())
+        this->options.segmentBytes = pageSize();
+
+#if !defined(MAPPED_LOG_WITH_ZLIB)
+    if (this->options.compressClosedSegments) {
+        std::cerr << "MappedLogOutput: built without MAPPED_LOG_WITH_ZLIB, closed segments stay uncompressed" << std::endl;
+        this->options.compressClosedSegments = false;
+    }
+#endif
+
+    // Never overwrite the segments of an earlier run
+    while (fileExists(basePath + "." + std::to_string(nextIndex))
+           || fileExists(basePath + "." + std::to_string(nextIndex) + ".gz"))
+        ++nextIndex;
+
+    if (!openSegment(this->options.segmentBytes))
+        throw std::runtime_error("MappedLogOutput: cannot create " + segmentPath);
+
+    if (this->options.compressClosedSegments || this->options.onSegmentClosed)
+        background = std::thread(&MappedLogOutput::backgroundThread, this);
+}
+
+MappedLogOutput::~MappedLogOutput() {
+    closeSegment();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (background.joinable())
+        background.join();     // finishes every queued segment first
+}
+
+void MappedLogOutput::write(const char* data, size_t size) {
+    if (size == 0)
+        return;
+
+    // Roll only here, between writes: the batch goes whole into the next segment
+    if (mapping && size > segmentRoom())
+        closeSegment();
+    if (!mapping && !openSegment(std::max(size, options.segmentBytes)))
+        return;     // already reported; this batch is lost, the next one tries again
+
+    std::memcpy(mapping + used, data, size);
+    used += size;
+}
+
+size_t MappedLogOutput::segmentRoom() const {
+    // The age is left to flush(): a write rolls exactly when this says it will
+    return mapping ? capacity - used : 0;
+}
+
+void MappedLogOutput::flush() {
+    if (!mapping)
+        return;
+
+    if (used > flushedUpTo) {
+        // Start writeback of the dirty pages only; the disk is never waited for
+        size_t from = flushedUpTo - flushedUpTo % pageSize();
+#if defined(_WIN32)
+        FlushViewOfFile(mapping + from, used - from);
+#else
+        msync(mapping + from, used - from, MS_ASYNC);
+#endif
+        flushedUpTo = used;
+    }
+
+    // Segments close by age only here, so a quiet logger still closes its
+    // segment on time and write() never rolls behind segmentRoom()'s back
+    if (used > 0 && std::chrono::steady_clock::now() - openedAt >= options.maxSegmentAge)
+        closeSegment();
+}
+
+bool MappedLogOutput::openSegment(size_t bytes) {
+    segmentPath = basePath + "." + std::to_string(nextIndex++);
+    used = 0;
+    flushedUpTo = 0;
+    openedAt = std::chrono::steady_clock::now();
+
+#if defined(_WIN32)
+    HANDLE h = CreateFileA(segmentPath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                           CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to create log segment: " << segmentPath << std::endl;
+        return false;
+    }
+    // Creating the mapping grows the file to the full segment size
+    unsigned long long size = bytes;
+    HANDLE m = CreateFileMappingA(h, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                  static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    void* view = m ? MapViewOfFile(m, FILE_MAP_WRITE, 0, 0, bytes) : nullptr;
+    if (!view) {
+        std::cerr << "Failed to map log segment: " << segmentPath << std::endl;
+        if (m)
+            CloseHandle(m);
+        CloseHandle(h);
+        return false;
+    }
+    file = h;
+    fileMapping = m;
+    mapping = static_cast<char*>(view);
+#else
+    fd = ::open(segmentPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create log segment: " << segmentPath << std::endl;
+        return false;
+    }
+    bool sized = ftruncate(fd, static_cast<off_t>(bytes)) == 0;
+#if defined(__linux__)
+    // Reserve the blocks now: a full disk is an error here rather than a
+    // SIGBUS on some later memcpy into a sparse page
+    sized = sized && posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0;
+#endif
+    void* view = sized ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (view == MAP_FAILED) {
+        std::cerr << "Failed to map log segment: " << segmentPath << std::endl;
+        ::close(fd);
+        fd = -1;
+        std::remove(segmentPath.c_str());
+        return false;
+    }
+    mapping = static_cast<char*>(view);
+#endif
+    capacity = bytes;
+    return true;
+}
+
+void MappedLogOutput::closeSegment() {
+    if (!mapping)
+        return;
+
+    // Unmapping leaves the dirty pages in the page cache; the OS writes them
+    // back on its own schedule. The file is cut to what was actually written.
+#if defined(_WIN32)
+    UnmapViewOfFile(mapping);
+    CloseHandle(fileMapping);
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(used);
+    SetFilePointerEx(file, end, nullptr, FILE_BEGIN);
+    SetEndOfFile(file);
+    CloseHandle(file);
+    file = nullptr;
+    fileMapping = nullptr;
+#else
+    munmap(mapping, capacity);
+    if (ftruncate(fd, static_cast<off_t>(used)) != 0)
+        std::cerr << "Failed to truncate log segment: " << segmentPath << std::endl;
+    ::close(fd);
+    fd = -1;
+#endif
+    mapping = nullptr;
+
+    if (used == 0) {
+        // Nothing went in (the first write was bigger than the segment): reuse the name
+        std::remove(segmentPath.c_str());
+        --nextIndex;
+        return;
+    }
+
+    if (background.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            closedSegments.push_back(segmentPath);
+        }
+        cv.notify_one();
+    }
+}
+
+void MappedLogOutput::backgroundThread() {
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stopping || !closedSegments.empty(); });
+            if (closedSegments.empty())
+                return;
+            path = std::move(closedSegments.front());
+            closedSegments.pop_front();
+        }
+
+        if (options.compressClosedSegments && compress(path))
+            path += ".gz";
+        if (options.onSegmentClosed)
+            options.onSegmentClosed(path);
+    }
+}
+
+bool MappedLogOutput::compress(const std::string& path) {
+#if defined(MAPPED_LOG_WITH_ZLIB)
+    std::ifstream in(path, std::ios::binary);
+    gzFile gz = gzopen((path + ".gz").c_str(), "wb");
+    if (!in || !gz) {
+        std::cerr << "Failed to compress log segment: " << path << std::endl;
+        if (gz)
+            gzclose(gz);
+        return false;
+    }
+
+    char chunk[64 * 1024];
+    bool ok = true;
+    while (ok && in) {
+        in.read(chunk, sizeof(chunk));
+        std::streamsize n = in.gcount();
+        if (n > 0)
+            ok = gzwrite(gz, chunk, static_cast<unsigned>(n)) == n;
+    }
+    ok = gzclose(gz) == Z_OK && ok;
+    in.close();
+
+    if (!ok) {
+        std::cerr << "Failed to compress log segment: " << path << std::endl;
+        std::remove((path + ".gz").c_str());
+        return false;
+    }
+    std::remove(path.c_str());
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "log_output.h"
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+struct MappedLogOptions {
+    size_t segmentBytes = 64 * 1024 * 1024;                // every segment file is created at this size and mapped whole
+    std::chrono::seconds maxSegmentAge{ 3600 };            // flush() closes a segment this old even if it is not full
+    bool compressClosedSegments = false;                   // gzip closed segments in the background (built with MAPPED_LOG_WITH_ZLIB)
+    std::function<void(const std::string& path)> onSegmentClosed;   // runs on the background thread, after compression
+};
+
+/*
+    Writes the logger's batches into memory-mapped segment files named
+    "<basePath>.1", "<basePath>.2", ... (numbering continues after any
+    segment already on disk).
+
+    A segment is created at its full size and mapped once, so a write is a
+    memcpy into the page cache: no syscall per batch, and a crash of the
+    process loses nothing that was written. flush() only asks the OS to
+    start writing dirty pages back (msync MS_ASYNC / FlushViewOfFile) and
+    never waits for the disk, so after a crash of the machine itself at
+    most the data written since the last flush is lost.
+
+    A write() that does not fit in segmentRoom() goes whole into the next
+    segment (one bigger than segmentBytes if the write alone is), so an
+    entry never straddles segments. A closed segment is truncated to the
+    bytes actually written and queued for a background thread that
+    compresses it (to "<segment>.gz") and calls onSegmentClosed.
+*/
+class MappedLogOutput : public LogOutput {
+public:
+    explicit MappedLogOutput(const std::string& basePath, MappedLogOptions options = MappedLogOptions());
+    ~MappedLogOutput() override;
+
+    MappedLogOutput(const MappedLogOutput&) = delete;
+    MappedLogOutput& operator=(const MappedLogOutput&) = delete;
+
+    void write(const char* data, size_t size) override;
+    void flush() override;
+    size_t segmentRoom() const override;
+
+    const std::string& currentSegment() const { return segmentPath; }
+
+private:
+    bool openSegment(size_t bytes);
+    void closeSegment();
+    void backgroundThread();
+    static bool compress(const std::string& path);
+
+    std::string basePath;
+    MappedLogOptions options;
+    unsigned nextIndex;
+
+    // Segment being written; mapping == nullptr between segments
+    std::string segmentPath;
+    char* mapping;
+    size_t capacity;                                       // bytes mapped: segmentBytes, or one oversized write
+    size_t used;
+    size_t flushedUpTo;                                    // [flushedUpTo, used) has not been flushed
+    std::chrono::steady_clock::time_point openedAt;
+#if defined(_WIN32)
+    void* file;                                            // HANDLEs, kept as void* to keep windows.h out of here
+    void* fileMapping;
+#else
+    int fd;
+#endif
+
+    // Closed segments waiting for compression and the callback
+    std::thread background;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::string> closedSegments;
+    bool stopping;
+};
@@ -0,0 +1,587 @@
+#include "CommitLog.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+    // On-disk record: [uint32 length][uint32 crc32][payload]. The CRC covers
+    // the length too, so a zero-filled tail never reads back as valid records.
+    constexpr size_t HeaderBytes = 2 * sizeof(uint32_t);
+    constexpr size_t ReadAheadBytes = 64 * 1024;
+
+    struct IndexEntry {
+        uint32_t relativeOffset;
+        uint32_t position;
+    };
+
+    constexpr std::array<uint32_t, 256> makeCrcTable() {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint32_t, 256> CrcTable = makeCrcTable();
+
+    uint32_t crc32Update(uint32_t crc, const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            crc = CrcTable[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    uint32_t recordCrc(uint32_t length, const char* payload) {
+        uint32_t crc = crc32Update(0xFFFFFFFFu, reinterpret_cast<const char*>(&length), sizeof(length));
+        return ~crc32Update(crc, payload, length);
+    }
+
+    // Thin layer over the platform file API: appends go to the end of the
+    // file, reads are positional so they never disturb an appender
+#if defined(_WIN32)
+    using FileHandle = HANDLE;
+    const FileHandle InvalidFile = INVALID_HANDLE_VALUE;
+
+    FileHandle openFile(const std::string& path) {
+        // Append-only access: every WriteFile lands at the current end of file
+        return CreateFileA(path.c_str(), GENERIC_READ | FILE_APPEND_DATA,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    }
+
+    void closeFile(FileHandle file) { CloseHandle(file); }
+
+    bool writeAll(FileHandle file, const char* data, size_t size) {
+        while (size > 0) {
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            DWORD written = 0;
+            if (!WriteFile(file, data, chunk, &written, nullptr) || written == 0) return false;
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool readAt(FileHandle file, uint64_t position, char* data, size_t size) {
+        while (size > 0) {
+            OVERLAPPED at = {};
+            at.Offset = static_cast<DWORD>(position);
+            at.OffsetHigh = static_cast<DWORD>(position >> 32);
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            DWORD got = 0;
+            if (!ReadFile(file, data, chunk, &got, &at) || got == 0) return false;
+            data += got;
+            position += got;
+            size -= got;
+        }
+        return true;
+    }
+
+    bool syncFile(FileHandle file) { return FlushFileBuffers(file) != 0; }
+
+    // NTFS makes the directory entry durable with the file
+    void syncDirectory(const std::string&) {}
+#else
+    using FileHandle = int;
+    const FileHandle InvalidFile = -1;
+
+    FileHandle openFile(const std::string& path) {
+        return open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+
+    void closeFile(FileHandle file) { close(file); }
+
+    bool writeAll(FileHandle file, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = write(file, data, size);
+            if (written <= 0) return false;
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool readAt(FileHandle file, uint64_t position, char* data, size_t size) {
+        while (size > 0) {
+            ssize_t got = pread(file, data, size, static_cast<off_t>(position));
+            if (got <= 0) return false;
+            data += got;
+            position += static_cast<uint64_t>(got);
+            size -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    bool syncFile(FileHandle file) {
+#if defined(__linux__)
+        return fdatasync(file) == 0;
+#else
+        return fsync(file) == 0;
+#endif
+    }
+
+    // A new segment file survives a crash only once its directory entry does
+    void syncDirectory(const std::string& path) {
+        int dir = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (dir < 0) return;
+        fsync(dir);
+        close(dir);
+    }
+#endif
+
+    // Sequential reader over [0, limit) of a segment file with read-ahead,
+    // so scanning small records costs one pread per ReadAheadBytes
+    class SegmentReader {
+    private:
+        FileHandle file;
+        uint64_t limit;
+        std::string buffer;
+        uint64_t bufferStart = 0;
+        size_t bufferSize = 0;
+
+    public:
+        SegmentReader(FileHandle f, uint64_t size) : file(f), limit(size) {}
+
+        // Bytes [position, position + size), or nullptr past the limit or on a
+        // read error. Valid until the next call.
+        const char* fetch(uint64_t position, size_t size) {
+            if (position > limit || size > limit - position) return nullptr;
+            if (position < bufferStart || position + size > bufferStart + bufferSize) {
+                size_t want = static_cast<size_t>(std::min<uint64_t>(std::max(size, ReadAheadBytes), limit - position));
+                if (buffer.size() < want) buffer.resize(want);
+                bufferSize = 0;
+                if (!readAt(file, position, &buffer[0], want)) return nullptr;
+                bufferStart = position;
+                bufferSize = want;
+            }
+            return buffer.data() + (position - bufferStart);
+        }
+
+        // Validates the record at position; returns its payload or nullptr
+        const char* record(uint64_t position, uint32_t& length) {
+            const char* header = fetch(position, HeaderBytes);
+            if (!header) return nullptr;
+            uint32_t crc;
+            std::memcpy(&length, header, sizeof(length));
+            std::memcpy(&crc, header + sizeof(length), sizeof(crc));
+            const char* payload = fetch(position + HeaderBytes, length);
+            if (!payload || recordCrc(length, payload) != crc) return nullptr;
+            return payload;
+        }
+    };
+
+    std::string segmentName(uint64_t baseOffset) {
+        std::ostringstream name;
+        name << std::setw(20) << std::setfill('0') << baseOffset;
+        return name.str();
+    }
+
+} // namespace
+
+namespace KafkaSystem {
+
+    struct CommitLog::Segment {
+        uint64_t baseOffset = 0;
+        std::string logPath;
+        std::string indexPath;
+        FileHandle file = InvalidFile;
+        uint64_t bytes = 0;                 // valid log bytes
+        uint64_t count = 0;                 // records
+        std::vector<IndexEntry> index;      // sparse, ascending; first entry is (0, 0)
+        uint64_t lastIndexedPosition = 0;
+
+        Segment(const std::string& directory, uint64_t base)
+            : baseOffset(base),
+              logPath((fs::path(directory) / (segmentName(base) + ".log")).string()),
+              indexPath((fs::path(directory) / (segmentName(base) + ".index")).string()) {}
+
+        ~Segment() {
+            if (file != InvalidFile) closeFile(file);
+        }
+
+        // Adds an index entry if this record starts a new index interval
+        void indexRecord(uint64_t position, size_t intervalBytes) {
+            if (count == 0 || position - lastIndexedPosition >= intervalBytes) {
+                index.push_back(IndexEntry{ static_cast<uint32_t>(count), static_cast<uint32_t>(position) });
+                lastIndexedPosition = position;
+            }
+        }
+    };
+
+    CommitLog::CommitLog(const std::string& dir, const CommitLogOptions& logOptions)
+        : directory(dir), options(logOptions) {
+        // Positions in the sparse index are 32-bit
+        options.segmentBytes = std::min<size_t>(std::max<size_t>(options.segmentBytes, 4096), size_t(1) << 30);
+        if (options.indexIntervalBytes == 0) options.indexIntervalBytes = 1;
+
+        std::error_code error;
+        fs::create_directories(directory, error);
+        if (error) {
+            throw std::runtime_error("CommitLog: cannot create " + directory + ": " + error.message());
+        }
+        recover();
+    }
+
+    CommitLog::~CommitLog() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!failed && syncedOffset < endOffset &&
+            (options.fsyncEveryMessages > 0 || options.fsyncInterval.count() > 0)) {
+            syncFile(segments.back()->file);
+        }
+    }
+
+    void CommitLog::recover() {
+        std::vector<uint64_t> bases;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            std::string stem = entry.path().stem().string();
+            if (entry.path().extension() != ".log" || stem.empty() ||
+                stem.find_first_not_of("0123456789") != std::string::npos) continue;
+            bases.push_back(std::stoull(stem));
+        }
+        std::sort(bases.begin(), bases.end());
+
+        for (size_t i = 0; i < bases.size(); ++i) {
+            auto segment = std::make_shared<Segment>(directory, bases[i]);
+            segment->bytes = fs::file_size(segment->logPath);
+            segment->file = openFile(segment->logPath);
+            if (segment->file == InvalidFile) {
+                throw std::runtime_error("CommitLog: cannot open " + segment->logPath);
+            }
+
+            bool sealed = i + 1 < bases.size();
+            if (sealed && sealedIntact(*segment, bases[i + 1] - bases[i])) {
+                segments.push_back(std::move(segment));
+                continue;
+            }
+
+            // The active segment may end in a torn write: keep the records
+            // that pass their CRC and cut the file after the last of them
+            uint64_t valid = scanSegment(*segment);
+            if (sealed) {
+                // A sealed segment that lost records (sealing does not sync under
+                // the "never" policy) ends the log: later segments would leave a
+                // gap in the offsets, so they go and this one becomes active
+                std::cerr << "CommitLog: " << segment->logPath << " holds " << segment->count << " of "
+                          << bases[i + 1] - bases[i] << " records; dropping the log after it" << std::endl;
+                for (size_t j = i + 1; j < bases.size(); ++j) {
+                    Segment later(directory, bases[j]);
+                    truncatedBytes += fs::file_size(later.logPath);
+                    fs::remove(later.logPath);
+                    fs::remove(later.indexPath);
+                }
+                fs::remove(segment->indexPath);
+            }
+            if (valid < segment->bytes) {
+                uint64_t torn = segment->bytes - valid;
+                truncatedBytes += torn;
+                closeFile(segment->file);
+                fs::resize_file(segment->logPath, valid);
+                segment->bytes = valid;
+                segment->file = openFile(segment->logPath);
+                if (segment->file == InvalidFile) {
+                    throw std::runtime_error("CommitLog: cannot reopen " + segment->logPath);
+                }
+                std::cerr << "CommitLog: truncated " << torn << " torn bytes from "
+                          << segment->logPath << std::endl;
+            }
+            segments.push_back(std::move(segment));
+            if (sealed) break;
+        }
+
+        if (segments.empty()) {
+            openSegment(0);
+        }
+        startOffset = segments.front()->baseOffset;
+        endOffset = segments.back()->baseOffset + segments.back()->count;
+        recoveredOffset = endOffset;
+
+        // An earlier run may have left records only in the page cache; with a
+        // sync policy, what was recovered is made durable before it is served
+        if (options.fsyncEveryMessages > 0 || options.fsyncInterval.count() > 0) {
+            for (auto& segment : segments) {
+                if (!syncFile(segment->file)) {
+                    throw std::runtime_error("CommitLog: cannot sync " + segment->logPath);
+                }
+            }
+        }
+        syncedOffset = endOffset;
+        syncingOffset = endOffset;
+    }
+
+    // Accepts <base>.index only if it is consistent with the log file
+    bool CommitLog::loadIndex(Segment& segment) {
+        std::ifstream in(segment.indexPath, std::ios::binary);
+        if (!in) return false;
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (bytes.empty() || bytes.size() % sizeof(IndexEntry) != 0) return false;
+
+        std::vector<IndexEntry> entries(bytes.size() / sizeof(IndexEntry));
+        std::memcpy(entries.data(), bytes.data(), bytes.size());
+        if (entries[0].relativeOffset != 0 || entries[0].position != 0) return false;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].relativeOffset >= segment.count || entries[i].position >= segment.bytes) return false;
+            if (i > 0 && (entries[i].relativeOffset <= entries[i - 1].relativeOffset ||
+                          entries[i].position <= entries[i - 1].position)) return false;
+        }
+        segment.index = std::move(entries);
+        segment.lastIndexedPosition = segment.index.back().position;
+        return true;
+    }
+
+    // A sealed segment must hold exactly expected records filling the file.
+    // With a usable index only the records after its last entry are checked.
+    bool CommitLog::sealedIntact(Segment& segment, uint64_t expected) {
+        segment.count = expected;
+        if (!loadIndex(segment)) {
+            return scanSegment(segment) == segment.bytes && segment.count == expected;
+        }
+
+        SegmentReader reader(segment.file, segment.bytes);
+        uint64_t position = segment.index.back().position;
+        uint64_t current = segment.index.back().relativeOffset;
+        uint32_t length;
+        while (current < expected && reader.record(position, length)) {
+            position += HeaderBytes + length;
+            ++current;
+        }
+        return current == expected && position == segment.bytes;
+    }
+
+    // Rebuilds count and index from the records themselves; returns the
+    // length of the valid prefix
+    uint64_t CommitLog::scanSegment(Segment& segment) {
+        SegmentReader reader(segment.file, segment.bytes);
+        segment.index.clear();
+        segment.count = 0;
+
+        uint64_t position = 0;
+        uint32_t length;
+        while (reader.record(position, length)) {
+            segment.indexRecord(position, options.indexIntervalBytes);
+            position += HeaderBytes + length;
+            ++segment.count;
+        }
+        return position;
+    }
+
+    // Called with mtx held
+    void CommitLog::openSegment(uint64_t baseOffset) {
+        auto segment = std::make_shared<Segment>(directory, baseOffset);
+        segment->file = openFile(segment->logPath);
+        if (segment->file == InvalidFile) {
+            failed = true;
+            throw std::runtime_error("CommitLog: cannot create " + segment->logPath);
+        }
+        if (options.fsyncEveryMessages > 0 || options.fsyncInterval.count() > 0) {
+            syncDirectory(directory);
+        }
+        segments.push_back(std::move(segment));
+    }
+
+    // Called with mtx held: the active segment becomes read-only
+    void CommitLog::sealActive() {
+        Segment& active = *segments.back();
+        if (options.fsyncEveryMessages > 0 || options.fsyncInterval.count() > 0) {
+            if (!syncFile(active.file)) {
+                failed = true;
+                syncDone.notify_all();
+                throw std::runtime_error("CommitLog: sync of " + active.logPath + " failed");
+            }
+            ++syncCount;
+            // Everything so far is in this segment or an older, already synced one
+            syncedOffset = endOffset;
+            syncingOffset = std::max(syncingOffset, endOffset);
+            syncDone.notify_all();
+        }
+
+        std::ofstream out(active.indexPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(active.index.data()),
+                  static_cast<std::streamsize>(active.index.size() * sizeof(IndexEntry)));
+        if (!out) {
+            // Not fatal: recovery rescans a segment whose index does not load
+            std::cerr << "CommitLog: cannot write " << active.indexPath << std::endl;
+        }
+    }
+
+    // Called with mtx held
+    void CommitLog::writePending() {
+        if (writeBuffer.empty()) return;
+        bool written = writeAll(segments.back()->file, writeBuffer.data(), writeBuffer.size());
+        writeBuffer.clear();
+        if (!written) {
+            // The file may now end in a partial record; recovery will cut it
+            failed = true;
+            throw std::runtime_error("CommitLog: write to " + segments.back()->logPath + " failed");
+        }
+    }
+
+    bool CommitLog::append(const std::string_view* records, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (records[i].size() > 0xFFFFFFFFu - HeaderBytes) {
+                throw std::length_error("Record larger than 4 GiB");
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (failed) {
+            throw std::runtime_error("CommitLog: " + directory + " is offline after a write or sync error");
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            if (segments.back()->count > 0 && segments.back()->bytes >= options.segmentBytes) {
+                writePending();
+                sealActive();
+                openSegment(endOffset);
+            }
+
+            Segment& active = *segments.back();
+            uint32_t length = static_cast<uint32_t>(records[i].size());
+            uint32_t crc = recordCrc(length, records[i].data());
+            active.indexRecord(active.bytes, options.indexIntervalBytes);
+
+            writeBuffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            writeBuffer.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+            writeBuffer.append(records[i].data(), records[i].size());
+
+            active.bytes += HeaderBytes + length;
+            ++active.count;
+            ++endOffset;
+        }
+        writePending();
+
+        // Records an epoch already in flight will cover do not count: with
+        // fsyncEveryMessages = 1 every append syncs, but appends that arrive
+        // during one fsync share the next
+        return options.fsyncEveryMessages > 0 && endOffset - syncingOffset >= options.fsyncEveryMessages;
+    }
+
+    void CommitLog::sync() {
+        std::unique_lock<std::mutex> lock(mtx);
+        uint64_t target = endOffset;
+        while (syncedOffset < target) {
+            if (failed) {
+                throw std::runtime_error("CommitLog: " + directory + " is offline after a write or sync error");
+            }
+            if (syncing) {
+                // The running epoch may not cover target; then the next one will
+                syncDone.wait(lock);
+                continue;
+            }
+
+            // Lead an epoch: fsync everything written so far, appends continue meanwhile
+            syncing = true;
+            uint64_t epochEnd = endOffset;
+            syncingOffset = epochEnd;
+            std::shared_ptr<Segment> active = segments.back();
+            lock.unlock();
+            bool synced = syncFile(active->file);
+            lock.lock();
+
+            syncing = false;
+            if (synced) {
+                ++syncCount;
+                syncedOffset = std::max(syncedOffset, epochEnd);
+            }
+            else {
+                failed = true;
+            }
+            syncDone.notify_all();
+            if (!synced) {
+                throw std::runtime_error("CommitLog: sync of " + active->logPath + " failed");
+            }
+        }
+    }
+
+    uint64_t CommitLog::getEndOffset() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return endOffset;
+    }
+
+    size_t CommitLog::segmentCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return segments.size();
+    }
+
+    uint64_t CommitLog::getSyncCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return syncCount;
+    }
+
+    std::shared_ptr<const StoredRecords> CommitLog::read(uint64_t offset, size_t maxCount) const {
+        auto result = std::make_shared<StoredRecords>();
+        result->firstOffset = offset;
+        std::vector<std::pair<size_t, uint32_t>> found;    // (start in bytes, length)
+
+        uint64_t next = offset;
+        while (found.size() < maxCount) {
+            std::shared_ptr<Segment> segment;
+            uint64_t position, current, limit, segmentEnd;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (next >= endOffset || next < startOffset) break;
+
+                auto it = std::upper_bound(segments.begin(), segments.end(), next,
+                    [](uint64_t value, const std::shared_ptr<Segment>& s) { return value < s->baseOffset; });
+                segment = *(it - 1);
+
+                // Nearest index entry at or before the wanted offset
+                uint64_t relative = next - segment->baseOffset;
+                auto entry = std::upper_bound(segment->index.begin(), segment->index.end(), relative,
+                    [](uint64_t value, const IndexEntry& e) { return value < e.relativeOffset; });
+                if (entry == segment->index.begin()) break;     // no records indexed: nothing to read
+                --entry;
+                position = entry->position;
+                current = segment->baseOffset + entry->relativeOffset;
+                limit = segment->bytes;
+                segmentEnd = segment->baseOffset + segment->count;
+            }
+
+            // Scan forward outside the lock; appends only add bytes past limit
+            SegmentReader reader(segment->file, limit);
+            while (current < segmentEnd && found.size() < maxCount) {
+                uint32_t length;
+                const char* payload = reader.record(position, length);
+                if (!payload) {
+                    std::cerr << "CommitLog: corrupt record at offset " << current
+                              << " in " << segment->logPath << std::endl;
+                    maxCount = found.size();
+                    break;
+                }
+                if (current >= next) {
+                    found.emplace_back(result->bytes.size(), length);
+                    result->bytes.append(payload, length);
+                }
+                position += HeaderBytes + length;
+                ++current;
+            }
+            next = current;
+        }
+
+        // Views last: appending to bytes may have moved it
+        result->records.reserve(found.size());
+        for (const auto& record : found) {
+            result->records.emplace_back(result->bytes.data() + record.first, record.second);
+        }
+        return result;
+    }
+
+} // namespace KafkaSystem
@@ -0,0 +1,107 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace KafkaSystem {
+
+    // CommitLogOptions - where partitions are persisted and when they are fsynced
+    // fsyncEveryMessages and fsyncInterval may be combined; with both at 0 the
+    // log never syncs and leaves write-back to the OS.
+    struct CommitLogOptions {
+        std::string directory;                          // one sub-directory per topic partition
+        size_t segmentBytes = 64 << 20;                 // roll to a new segment file past this size
+        size_t indexIntervalBytes = 4096;               // log bytes between sparse index entries
+        size_t fsyncEveryMessages = 0;                  // an append that leaves this many unsynced waits for a sync
+        std::chrono::milliseconds fsyncInterval{0};     // sync dirty partitions this often
+    };
+
+    // StoredRecords - records read back from disk; the views point into bytes
+    struct StoredRecords {
+        uint64_t firstOffset = 0;
+        std::string bytes;
+        std::vector<std::string_view> records;
+    };
+
+    // CommitLog - durable append-only log of one topic partition
+    // Records are appended to segment files named after their first offset
+    // (<base>.log) as [length][crc32][payload]. Each segment keeps a sparse
+    // offset index with one entry per indexIntervalBytes of log; it is written
+    // to <base>.index when the segment is sealed. Opening a directory recovers
+    // the log: the last segment is rescanned, its index rebuilt and anything
+    // after the last record with a valid CRC (a torn write) truncated. A
+    // sealed segment must hold as many records as the next base offset says;
+    // if it lost some, the log is cut after its valid records instead. Reads
+    // find the nearest index entry and pread forward from there, so no segment
+    // is ever loaded whole.
+    class CommitLog {
+    public:
+        CommitLog(const std::string& directory, const CommitLogOptions& options);
+        ~CommitLog();
+
+        CommitLog(const CommitLog&) = delete;
+        CommitLog& operator=(const CommitLog&) = delete;
+
+        // Writes count records with one write call; returns true when
+        // fsyncEveryMessages records are not yet covered by a sync, and the
+        // caller must sync() before it reports them written.
+        // Throws std::runtime_error if the write fails.
+        bool append(const std::string_view* records, size_t count);
+
+        // Returns once every record appended before the call is on stable
+        // storage. Syncs run in epochs without the append lock: one caller
+        // fsyncs everything written so far while the others wait for the
+        // epoch that covers their records, so concurrent appends share fsyncs.
+        // Throws std::runtime_error if an fsync fails; the log then refuses
+        // further appends.
+        void sync();
+
+        uint64_t getEndOffset() const;
+        uint64_t getStartOffset() const { return startOffset; }           // base of the first segment found on open
+        uint64_t getRecoveredOffset() const { return recoveredOffset; }   // end offset found on open
+        uint64_t getTruncatedBytes() const { return truncatedBytes; }     // torn or orphaned bytes dropped on open
+        size_t segmentCount() const;
+        uint64_t getSyncCount() const;
+
+        // Up to maxCount records from offset, crossing segments as needed; fewer
+        // only at the end of the log or at a record that fails its CRC, none
+        // below getStartOffset()
+        std::shared_ptr<const StoredRecords> read(uint64_t offset, size_t maxCount) const;
+
+    private:
+        struct Segment;
+
+        void recover();
+        void openSegment(uint64_t baseOffset);
+        void sealActive();
+        bool loadIndex(Segment& segment);
+        bool sealedIntact(Segment& segment, uint64_t expected);
+        uint64_t scanSegment(Segment& segment);
+        void writePending();
+
+        std::string directory;
+        CommitLogOptions options;
+
+        mutable std::mutex mtx;                         // guards everything below
+        std::vector<std::shared_ptr<Segment>> segments; // by base offset; back() is active
+        uint64_t endOffset = 0;
+        uint64_t syncedOffset = 0;                      // records below are on stable storage
+        uint64_t syncingOffset = 0;                     // ... or will be when the running epoch ends
+        bool syncing = false;                           // an epoch's fsync is running
+        std::condition_variable syncDone;
+        uint64_t syncCount = 0;
+        bool failed = false;                            // a write or fsync failed; refuse further appends
+        std::string writeBuffer;
+
+        uint64_t startOffset = 0;
+        uint64_t recoveredOffset = 0;
+        uint64_t truncatedBytes = 0;
+    };
+
+} // namespace KafkaSystem
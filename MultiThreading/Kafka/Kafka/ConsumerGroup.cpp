@@ -0,0 +1,271 @@
+#include "ConsumerGroup.h"
+#include <algorithm>
+#include <iostream>
+
+namespace KafkaSystem {
+
+    ConsumerGroup::ConsumerGroup(const std::string& id, std::shared_ptr<Topic> t,
+                                 AssignmentStrategy assignmentStrategy)
+        : groupId(id), topic(t), strategy(assignmentStrategy),
+          partitionOwner(t->getPartitionCount()),
+          committedOffsets(t->getPartitionCount()),
+          partitionBusy(t->getPartitionCount()) {
+        for (auto& owner : partitionOwner) owner.store(0);
+        for (auto& offset : committedOffsets) offset.store(0);
+        for (auto& busy : partitionBusy) busy.store(0);
+    }
+
+    ConsumerGroup::~ConsumerGroup() {
+        stop();
+    }
+
+    bool ConsumerGroup::join(std::shared_ptr<ISubscriber> subscriber) {
+        std::lock_guard<std::mutex> lock(groupMtx);
+
+        for (auto& member : members) {
+            if (member->subscriber->getId() == subscriber->getId()) return false;
+        }
+
+        auto member = std::make_unique<Member>();
+        member->subscriber = subscriber;
+        member->token = nextToken++;
+        Member* joined = member.get();
+        members.push_back(std::move(member));
+
+        rebalance();
+        joined->worker = std::thread([this, joined]() { run(*joined); });
+        return true;
+    }
+
+    bool ConsumerGroup::leave(const std::string& subscriberId) {
+        std::unique_ptr<Member> leaving;
+        {
+            std::lock_guard<std::mutex> lock(groupMtx);
+            auto it = std::find_if(members.begin(), members.end(), [&](const std::unique_ptr<Member>& m) {
+                return m->subscriber->getId() == subscriberId;
+            });
+            if (it == members.end()) return false;
+
+            leaving = std::move(*it);
+            members.erase(it);
+            {
+                std::lock_guard<std::mutex> waitLock(waitMtx);
+                leaving->running = false;
+            }
+            rebalance();
+        }
+
+        // Its partitions already have new owners; they skip any partition this
+        // member still has a batch in flight on until it releases it
+        if (leaving->worker.joinable()) leaving->worker.join();
+        return true;
+    }
+
+    void ConsumerGroup::stop() {
+        std::vector<std::unique_ptr<Member>> stopping;
+        {
+            std::lock_guard<std::mutex> lock(groupMtx);
+            stopping.swap(members);
+            std::lock_guard<std::mutex> waitLock(waitMtx);
+            for (auto& member : stopping) member->running = false;
+            for (auto& owner : partitionOwner) owner.store(0);
+        }
+        cv.notify_all();
+
+        for (auto& member : stopping) {
+            if (member->worker.joinable()) member->worker.join();
+        }
+    }
+
+    size_t ConsumerGroup::getMemberCount() {
+        std::lock_guard<std::mutex> lock(groupMtx);
+        return members.size();
+    }
+
+    std::vector<size_t> ConsumerGroup::getAssignment(const std::string& subscriberId) {
+        std::lock_guard<std::mutex> lock(groupMtx);
+        for (auto& member : members) {
+            if (member->subscriber->getId() == subscriberId) return member->partitions;
+        }
+        return {};
+    }
+
+    int ConsumerGroup::getGeneration() {
+        std::lock_guard<std::mutex> lock(groupMtx);
+        return generation;
+    }
+
+    void ConsumerGroup::commitOffset(size_t partition, int offset) {
+        // No lock: an in-flight batch only auto-commits if this did not move the offset
+        committedOffsets[partition].store(offset);
+        notifyNewMessage();
+    }
+
+    void ConsumerGroup::notifyNewMessage() {
+        // Members check for work under waitMtx before sleeping; see run()
+        { std::lock_guard<std::mutex> lock(waitMtx); }
+        cv.notify_all();
+    }
+
+    // Called with groupMtx held
+    void ConsumerGroup::rebalance() {
+        if (strategy == AssignmentStrategy::Sticky) {
+            assignSticky();
+        }
+        else {
+            assignRange();
+        }
+
+        std::vector<int> owners(partitionOwner.size(), 0);
+        for (auto& member : members) {
+            for (size_t partition : member->partitions) owners[partition] = member->token;
+        }
+        {
+            std::lock_guard<std::mutex> waitLock(waitMtx);
+            for (size_t p = 0; p < owners.size(); ++p) partitionOwner[p].store(owners[p]);
+        }
+        ++generation;
+        cv.notify_all();
+
+        std::cout << "Group " << groupId << " rebalanced ("
+                  << (strategy == AssignmentStrategy::Sticky ? "sticky" : "range")
+                  << ", generation " << generation << "):";
+        for (auto& member : members) {
+            std::cout << " " << member->subscriber->getId() << " -> [";
+            for (size_t i = 0; i < member->partitions.size(); ++i) {
+                std::cout << (i ? ", " : "") << member->partitions[i];
+            }
+            std::cout << "]";
+        }
+        std::cout << std::endl;
+    }
+
+    // Members in id order, each gets a contiguous block; the first
+    // (partitions % members) members get one extra partition
+    void ConsumerGroup::assignRange() {
+        std::vector<Member*> ordered;
+        for (auto& member : members) ordered.push_back(member.get());
+        std::sort(ordered.begin(), ordered.end(), [](const Member* a, const Member* b) {
+            return a->subscriber->getId() < b->subscriber->getId();
+        });
+
+        size_t partitionCount = partitionOwner.size();
+        size_t next = 0;
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            size_t share = partitionCount / ordered.size() + (i < partitionCount % ordered.size() ? 1 : 0);
+            ordered[i]->partitions.clear();
+            for (size_t k = 0; k < share; ++k) ordered[i]->partitions.push_back(next++);
+        }
+    }
+
+    // Same per-member counts as Range, but every member first keeps as many of
+    // its current partitions as its quota allows; only the surplus and the
+    // partitions of departed members move
+    void ConsumerGroup::assignSticky() {
+        if (members.empty()) return;
+
+        std::vector<Member*> ordered;
+        for (auto& member : members) ordered.push_back(member.get());
+        // Members holding the most get the larger quotas, so fewer partitions move
+        std::stable_sort(ordered.begin(), ordered.end(), [](const Member* a, const Member* b) {
+            if (a->partitions.size() != b->partitions.size()) return a->partitions.size() > b->partitions.size();
+            return a->subscriber->getId() < b->subscriber->getId();
+        });
+
+        size_t partitionCount = partitionOwner.size();
+        std::vector<bool> taken(partitionCount, false);
+        std::vector<size_t> quota(ordered.size());
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            quota[i] = partitionCount / ordered.size() + (i < partitionCount % ordered.size() ? 1 : 0);
+
+            std::vector<size_t> kept;
+            for (size_t partition : ordered[i]->partitions) {
+                if (kept.size() == quota[i]) break;
+                if (partition < partitionCount && !taken[partition]) {
+                    taken[partition] = true;
+                    kept.push_back(partition);
+                }
+            }
+            ordered[i]->partitions = kept;
+        }
+
+        size_t next = 0;
+        for (size_t i = 0; i < ordered.size(); ++i) {
+            while (ordered[i]->partitions.size() < quota[i]) {
+                while (taken[next]) ++next;
+                taken[next] = true;
+                ordered[i]->partitions.push_back(next);
+            }
+            std::sort(ordered[i]->partitions.begin(), ordered[i]->partitions.end());
+        }
+    }
+
+    bool ConsumerGroup::hasWork(int token) const {
+        for (size_t p = 0; p < partitionOwner.size(); ++p) {
+            if (partitionOwner[p].load() == token && partitionBusy[p].load() == 0 &&
+                committedOffsets[p].load() < (int)topic->getMessageCount(p)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Handles the next batch of one partition if this member still owns it
+    bool ConsumerGroup::consumeBatch(Member& member, size_t partition) {
+        if (partitionOwner[partition].load() != member.token) return false;
+
+        // A previous owner may still be running handlers on it; try again once it releases
+        int idle = 0;
+        if (!partitionBusy[partition].compare_exchange_strong(idle, member.token)) return false;
+
+        bool handled = false;
+        if (partitionOwner[partition].load() == member.token) {
+            int offset = committedOffsets[partition].load();
+            int start = static_cast<int>(topic->getStartOffset(partition));
+            // Older records are gone from disk: resume at the oldest one kept
+            if (offset < start && committedOffsets[partition].compare_exchange_strong(offset, start)) offset = start;
+            MessageBatch batch = topic->getMessages(partition, offset, BatchSize);
+            if (!batch.empty()) {
+                for (MessageView message : batch) {
+                    try {
+                        member.subscriber->onMessage(message);
+                    }
+                    catch (const std::exception& e) {
+                        std::cerr << "Error processing message: " << e.what() << std::endl;
+                    }
+                }
+
+                // Auto-commit: the next owner of this partition resumes after the batch,
+                // unless a handler committed an offset outside it (a rewind or a skip)
+                int end = offset + (int)batch.size();
+                int current = committedOffsets[partition].load();
+                while (current >= offset && current < end &&
+                       !committedOffsets[partition].compare_exchange_weak(current, end)) {
+                }
+                handled = true;
+            }
+        }
+
+        partitionBusy[partition].store(0);
+        // A member that took the partition over meanwhile skipped it and may be asleep
+        if (partitionOwner[partition].load() != member.token) notifyNewMessage();
+        return handled;
+    }
+
+    void ConsumerGroup::run(Member& member) {
+        while (member.running) {
+            // One batch per owned partition per pass keeps partitions fair
+            bool progressed = false;
+            for (size_t p = 0; p < partitionOwner.size() && member.running; ++p) {
+                progressed |= consumeBatch(member, p);
+            }
+            if (progressed) continue;
+
+            std::unique_lock<std::mutex> lock(waitMtx);
+            cv.wait(lock, [this, &member]() {
+                return !member.running || hasWork(member.token);
+            });
+        }
+    }
+
+} // namespace KafkaSystem
@@ -0,0 +1,96 @@
+#pragma once
+#include "Topic.h"
+#include "ISubscriber.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+namespace KafkaSystem {
+
+    enum class AssignmentStrategy {
+        Range,      // contiguous blocks of partitions, members in id order
+        Sticky      // balanced like Range, but members keep what they already own
+    };
+
+    // ConsumerGroup - subscribers sharing a group id split a topic's partitions
+    // Every partition is owned by exactly one member, so each message is handled
+    // once per group and adding members adds consumer threads. Membership changes
+    // trigger a rebalance. Offsets are committed per partition for the whole
+    // group, so a partition picks up where its previous owner stopped.
+    class ConsumerGroup {
+    private:
+        // Messages a member takes from a partition per visit; committed once per batch
+        static constexpr size_t BatchSize = 64;
+
+        struct Member {
+            std::shared_ptr<ISubscriber> subscriber;
+            int token;                          // unique per join, stored in partitionOwner
+            std::vector<size_t> partitions;     // current assignment
+            std::atomic<bool> running{true};
+            std::thread worker;
+        };
+
+        std::string groupId;
+        std::shared_ptr<Topic> topic;
+        AssignmentStrategy strategy;
+
+        // Membership and assignment, guarded by groupMtx
+        std::mutex groupMtx;
+        std::vector<std::unique_ptr<Member>> members;
+        int nextToken = 1;
+        int generation = 0;
+
+        // Per partition: owning member token (0 = none), the committed offset and
+        // the token of the member with a batch in flight (0 = none). A member
+        // claims partitionBusy before taking a batch and releases it after the
+        // handlers ran, so a partition that moves during a rebalance is never
+        // handled by two members at once. No lock is held while handlers run.
+        std::vector<std::atomic<int>> partitionOwner;
+        std::vector<std::atomic<int>> committedOffsets;
+        std::vector<std::atomic<int>> partitionBusy;
+
+        // Idle members sleep here until a publish or a rebalance
+        std::mutex waitMtx;
+        std::condition_variable cv;
+
+        void rebalance();
+        void assignRange();
+        void assignSticky();
+        void run(Member& member);
+        bool consumeBatch(Member& member, size_t partition);
+        bool hasWork(int token) const;
+
+    public:
+        ConsumerGroup(const std::string& id, std::shared_ptr<Topic> t,
+                      AssignmentStrategy assignmentStrategy = AssignmentStrategy::Range);
+        ~ConsumerGroup();
+
+        ConsumerGroup(const ConsumerGroup&) = delete;
+        ConsumerGroup& operator=(const ConsumerGroup&) = delete;
+
+        std::string getGroupId() const { return groupId; }
+        AssignmentStrategy getStrategy() const { return strategy; }
+
+        // Returns false if a member with the same subscriber id is already in the group
+        bool join(std::shared_ptr<ISubscriber> subscriber);
+        // Stops the member's thread (after its in-flight batch) and rebalances
+        bool leave(const std::string& subscriberId);
+        void stop();
+
+        size_t getMemberCount();
+        std::vector<size_t> getAssignment(const std::string& subscriberId);
+        int getGeneration();
+
+        int getCommittedOffset(size_t partition) const { return committedOffsets[partition].load(); }
+        // Safe to call from a handler. A handler commit that points outside the
+        // batch in flight is kept; the batch's auto-commit only moves forward to its end.
+        void commitOffset(size_t partition, int offset);
+
+        void notifyNewMessage();
+    };
+
+} // namespace KafkaSystem
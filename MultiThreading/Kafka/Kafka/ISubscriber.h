@@ -10,7 +10,7 @@ namespace KafkaSystem {
     public:
         virtual ~ISubscriber() = default;
         virtual std::string getId() const = 0;
-        virtual void onMessage(std::shared_ptr<Message> message) = 0;
+        virtual void onMessage(const MessageView& message) = 0;
     };
 
 } // namespace KafkaSystem
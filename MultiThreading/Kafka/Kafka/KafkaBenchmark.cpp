@@ -0,0 +1,654 @@
+#include "KafkaController.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Standalone benchmark (own main, excluded from the default build).
+    Build it on its own, e.g.:
+        g++ -std=c++17 -O2 -pthread KafkaBenchmark.cpp SegmentedLog.cpp KafkaController.cpp TopicSubscriberController.cpp ConsumerGroup.cpp Topic.cpp CommitLog.cpp
+    The durability section writes under the system temp directory and removes it afterwards.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+// Track live heap bytes so we can report memory per stored message
+static std::atomic<size_t> liveBytes{0};
+
+namespace {
+    constexpr size_t HeaderBytes = alignof(std::max_align_t);
+}
+
+// Kept out of line: once new is inlined into a caller, GCC treats the size
+// header in front of the returned block as outside that object and warns
+// about it in delete (-Warray-bounds, -Wmismatched-new-delete)
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size)
+{
+    if (char* p = static_cast<char*>(std::malloc(size + HeaderBytes))) {
+        *reinterpret_cast<size_t*>(p) = size;
+        liveBytes.fetch_add(size, std::memory_order_relaxed);
+        return p + HeaderBytes;
+    }
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept
+{
+    if (!p)
+        return;
+    char* base = static_cast<char*>(p) - HeaderBytes;
+    liveBytes.fetch_sub(*reinterpret_cast<size_t*>(base), std::memory_order_relaxed);
+    std::free(base);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+namespace {
+    // The storage Topic used before SegmentedLog: one shared Message per publish
+    class VectorTopic {
+    private:
+        std::vector<std::shared_ptr<KafkaSystem::Message>> messages;
+        mutable std::mutex mtx;
+
+    public:
+        void addMessage(std::shared_ptr<KafkaSystem::Message> message) {
+            std::lock_guard<std::mutex> lock(mtx);
+            messages.push_back(message);
+        }
+
+        size_t getMessageCount() const {
+            std::lock_guard<std::mutex> lock(mtx);
+            return messages.size();
+        }
+
+        std::shared_ptr<KafkaSystem::Message> getMessageAt(size_t index) const {
+            std::lock_guard<std::mutex> lock(mtx);
+            return index < messages.size() ? messages[index] : nullptr;
+        }
+    };
+
+    struct StorageResult {
+        double publishNs;     // per message
+        double readNs;        // per message, sequential consumer
+        double bytesPerMessage;
+    };
+
+    // Payloads look like small log/event records: 20-40 bytes
+    std::string payload(size_t i)
+    {
+        return "event-" + std::to_string(i) + "-payload-abcdefgh";
+    }
+
+    StorageResult vectorTopic(size_t messages)
+    {
+        size_t before = liveBytes.load();
+        auto topic = std::make_unique<VectorTopic>();
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < messages; ++i)
+            topic->addMessage(std::make_shared<KafkaSystem::Message>(payload(i)));
+        auto published = Clock::now();
+
+        size_t checksum = 0;
+        for (size_t i = 0; i < topic->getMessageCount(); ++i)
+            checksum += topic->getMessageAt(i)->getContent().size();
+        auto read = Clock::now();
+
+        size_t bytes = liveBytes.load() - before;
+        if (checksum == 0)
+            std::cout << "empty read\n";
+
+        return StorageResult{
+            std::chrono::duration<double, std::nano>(published - start).count() / messages,
+            std::chrono::duration<double, std::nano>(read - published).count() / messages,
+            double(bytes) / messages };
+    }
+
+    StorageResult segmentedTopic(size_t messages)
+    {
+        size_t before = liveBytes.load();
+        auto topic = std::make_unique<KafkaSystem::Topic>("bench", "1");
+
+        // Same payload construction cost as the vector case, minus the Message object
+        auto start = Clock::now();
+        for (size_t i = 0; i < messages; ++i)
+            topic->addMessage(0, payload(i));
+        auto published = Clock::now();
+
+        size_t checksum = 0;
+        for (size_t i = 0; i < topic->getMessageCount(); ++i)
+            checksum += topic->getMessageAt(0, i).getContent().size();
+        auto read = Clock::now();
+
+        size_t bytes = liveBytes.load() - before;
+        if (checksum == 0)
+            std::cout << "empty read\n";
+
+        return StorageResult{
+            std::chrono::duration<double, std::nano>(published - start).count() / messages,
+            std::chrono::duration<double, std::nano>(read - published).count() / messages,
+            double(bytes) / messages };
+    }
+
+    // KafkaController logs every publish; keep that out of the measurements
+    class QuietStdout {
+    private:
+        std::streambuf* saved;
+
+    public:
+        QuietStdout() : saved(std::cout.rdbuf(nullptr)) {}
+        ~QuietStdout() {
+            std::cout.rdbuf(saved);
+            std::cout.clear();
+        }
+    };
+
+    // Handler with a fixed per-message wait (an RPC, a DB write...), checking per-key order
+    class OrderCheckingSubscriber : public KafkaSystem::ISubscriber {
+    private:
+        std::chrono::microseconds handlerDelay;
+        std::vector<long long> lastSequence;    // per key; a key is only consumed by one thread
+
+    public:
+        std::atomic<size_t> received{0};
+        std::atomic<size_t> outOfOrder{0};
+
+        OrderCheckingSubscriber(size_t keys, std::chrono::microseconds delay)
+            : handlerDelay(delay), lastSequence(keys, -1) {}
+
+        std::string getId() const override { return "bench"; }
+
+        void onMessage(const KafkaSystem::MessageView& message) override {
+            // content is "<key>:<sequence>"
+            std::string_view content = message.getContent();
+            size_t colon = content.find(':');
+            size_t key = std::stoul(std::string(content.substr(0, colon)));
+            long long sequence = std::stoll(std::string(content.substr(colon + 1)));
+            if (sequence <= lastSequence[key])
+                outOfOrder.fetch_add(1, std::memory_order_relaxed);
+            lastSequence[key] = sequence;
+
+            std::this_thread::sleep_for(handlerDelay);
+            received.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    struct PartitionResult {
+        double messagesPerSec;
+        size_t outOfOrder;
+    };
+
+    // Publish keyed messages to a topic with `partitions` partitions, then time one subscriber draining it
+    PartitionResult consumeWithPartitions(size_t partitions, size_t messages, size_t keys,
+                                          std::chrono::microseconds handlerDelay)
+    {
+        QuietStdout quiet;
+        KafkaSystem::KafkaController controller;
+        auto topic = controller.createTopic("bench", partitions);
+
+        for (size_t i = 0; i < messages; ++i) {
+            size_t key = i % keys;
+            controller.publish(nullptr, topic->getTopicId(), std::make_shared<KafkaSystem::Message>(
+                std::to_string(key), std::to_string(key) + ":" + std::to_string(i)));
+        }
+
+        auto subscriber = std::make_shared<OrderCheckingSubscriber>(keys, handlerDelay);
+        auto start = Clock::now();
+        controller.subscribe(subscriber, topic->getTopicId());
+        while (subscriber->received.load(std::memory_order_acquire) < messages)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        controller.shutdown();
+
+        return PartitionResult{ messages / elapsed.count(), subscriber->outOfOrder.load() };
+    }
+
+    // Same handler shape as above, shared by all members of a group
+    class CountingSubscriber : public KafkaSystem::ISubscriber {
+    private:
+        std::string id;
+        std::chrono::microseconds handlerDelay;
+        std::atomic<size_t>& received;
+
+    public:
+        CountingSubscriber(const std::string& subscriberId, std::chrono::microseconds delay, std::atomic<size_t>& counter)
+            : id(subscriberId), handlerDelay(delay), received(counter) {}
+
+        std::string getId() const override { return id; }
+
+        void onMessage(const KafkaSystem::MessageView&) override {
+            std::this_thread::sleep_for(handlerDelay);
+            received.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // `members` subscribers in one group drain a pre-filled topic; returns aggregate msgs/s
+    double consumeWithGroup(size_t members, size_t partitions, size_t messages,
+                            std::chrono::microseconds handlerDelay)
+    {
+        QuietStdout quiet;
+        KafkaSystem::KafkaController controller;
+        auto topic = controller.createTopic("bench", partitions);
+
+        for (size_t i = 0; i < messages; ++i) {
+            controller.publish(nullptr, topic->getTopicId(),
+                               std::make_shared<KafkaSystem::Message>("m" + std::to_string(i)));
+        }
+
+        std::atomic<size_t> received{0};
+        auto start = Clock::now();
+        for (size_t m = 0; m < members; ++m) {
+            controller.subscribe(std::make_shared<CountingSubscriber>("member" + std::to_string(m), handlerDelay, received),
+                                 topic->getTopicId(), "bench-group");
+        }
+        while (received.load(std::memory_order_acquire) < messages)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        controller.shutdown();
+
+        if (received.load() != messages)
+            std::cout << "group delivered " << received.load() << " of " << messages << "\n";
+        return messages / elapsed.count();
+    }
+
+    struct BatchResult {
+        double publishOnly;     // M msgs/s into a topic nobody reads
+        double endToEnd;        // M msgs/s from a producer thread to a polling consumer thread
+        size_t polls;           // non-empty poll() calls the consumer needed
+    };
+
+    // batch == 0 means the single-message publish(shared_ptr<Message>) path
+    void publishAll(KafkaSystem::KafkaController& controller, const std::string& topicId,
+                    const std::vector<KafkaSystem::Message>& messages, size_t batch)
+    {
+        for (size_t i = 0; i < messages.size(); i += (batch ? batch : 1)) {
+            if (batch == 0) {
+                controller.publish(nullptr, topicId, std::make_shared<KafkaSystem::Message>(messages[i]));
+            } else {
+                controller.publishBatch(topicId, messages.data() + i, std::min(batch, messages.size() - i));
+            }
+        }
+    }
+
+    BatchResult batchThroughput(const std::vector<KafkaSystem::Message>& messages, size_t batch)
+    {
+        QuietStdout quiet;
+        BatchResult result{};
+        {
+            KafkaSystem::KafkaController controller;
+            auto topic = controller.createTopic("bench");
+            auto start = Clock::now();
+            publishAll(controller, topic->getTopicId(), messages, batch);
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            result.publishOnly = messages.size() / elapsed.count() / 1e6;
+        }
+
+        KafkaSystem::KafkaController controller;
+        auto topic = controller.createTopic("bench");
+        std::atomic<size_t> unused{0};    // poll() hands batches to us, not to onMessage
+        auto consumer = controller.subscribeForPolling(
+            std::make_shared<CountingSubscriber>("poller", std::chrono::microseconds(0), unused),
+            topic->getTopicId()).front();
+
+        size_t maxPoll = batch ? batch : 1;
+        auto start = Clock::now();
+        std::thread producer([&] { publishAll(controller, topic->getTopicId(), messages, batch); });
+        size_t received = 0;
+        size_t bytes = 0;
+        while (received < messages.size()) {
+            KafkaSystem::MessageBatch polled = consumer->poll(maxPoll, std::chrono::milliseconds(100));
+            for (KafkaSystem::MessageView message : polled)
+                bytes += message.getContent().size();
+            if (!polled.empty())
+                ++result.polls;
+            received += polled.size();
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        producer.join();
+        controller.shutdown();
+
+        if (bytes == 0)
+            std::cout << "empty poll\n";
+        result.endToEnd = messages.size() / elapsed.count() / 1e6;
+        return result;
+    }
+
+    // `producers` threads each publish to their own topic. globalLock wraps every
+    // publish in one shared mutex, as the controller-wide lock used to.
+    double multiTopicPublish(size_t producers, size_t messagesPerProducer, bool globalLock)
+    {
+        QuietStdout quiet;
+        KafkaSystem::KafkaController controller;
+        std::vector<std::string> topicIds;
+        for (size_t p = 0; p < producers; ++p)
+            topicIds.push_back(controller.createTopic("bench" + std::to_string(p))->getTopicId());
+
+        auto message = std::make_shared<KafkaSystem::Message>("event-payload-0123456789abcdef");
+        std::mutex controllerLock;
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+                for (size_t i = 0; i < messagesPerProducer; ++i) {
+                    if (globalLock) {
+                        std::lock_guard<std::mutex> lock(controllerLock);
+                        controller.publish(nullptr, topicIds[p], message);
+                    } else {
+                        controller.publish(nullptr, topicIds[p], message);
+                    }
+                }
+            });
+        }
+
+        auto start = Clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& t : threads)
+            t.join();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return producers * messagesPerProducer / elapsed.count() / 1e6;
+    }
+
+    struct DurableResult {
+        double messagesPerSec;
+        double p50Us, p99Us, maxUs;     // per publish() call
+        uint64_t syncs;
+    };
+
+    // `producers` threads publish `messages` in total to a one-partition topic,
+    // durable unless persistence is null, timing every publish() call
+    DurableResult durablePublish(const KafkaSystem::CommitLogOptions* persistence, size_t producers, size_t messages)
+    {
+        QuietStdout quiet;
+        auto controller = persistence ? std::make_unique<KafkaSystem::KafkaController>(*persistence)
+                                      : std::make_unique<KafkaSystem::KafkaController>();
+        auto topic = controller->createTopic("durable");
+
+        auto message = std::make_shared<KafkaSystem::Message>("event-payload-0123456789abcdef");
+        std::vector<std::vector<double>> latencies(producers);
+        std::vector<std::thread> threads;
+        auto start = Clock::now();
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                latencies[p].reserve(messages / producers);
+                for (size_t i = 0; i < messages / producers; ++i) {
+                    auto before = Clock::now();
+                    controller->publish(nullptr, topic->getTopicId(), message);
+                    latencies[p].push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        std::vector<double> all;
+        for (auto& l : latencies)
+            all.insert(all.end(), l.begin(), l.end());
+        std::sort(all.begin(), all.end());
+        DurableResult result{};
+        result.messagesPerSec = all.size() / elapsed.count();
+        result.p50Us = all[all.size() / 2];
+        result.p99Us = all[all.size() * 99 / 100];
+        result.maxUs = all.back();
+        result.syncs = persistence ? topic->getCommitLog(0)->getSyncCount() : 0;
+        controller->shutdown();
+        return result;
+    }
+
+    // Reopens a durable topic left by an earlier run and reads it back from disk
+    void recoverAndRead(const KafkaSystem::CommitLogOptions& persistence)
+    {
+        size_t heapBefore = liveBytes.load();
+        auto start = Clock::now();
+        KafkaSystem::Topic topic("durable", "1", 1, persistence);
+        std::chrono::duration<double, std::milli> openMs = Clock::now() - start;
+        size_t heapAfterOpen = liveBytes.load();
+
+        size_t count = topic.getMessageCount(0);
+        size_t bytes = 0;
+        start = Clock::now();
+        for (size_t offset = 0; offset < count;) {
+            KafkaSystem::MessageBatch batch = topic.getMessages(0, offset, 64);
+            for (KafkaSystem::MessageView message : batch)
+                bytes += message.getContent().size();
+            offset += batch.size();
+            if (batch.empty())
+                break;
+        }
+        std::chrono::duration<double> readSeconds = Clock::now() - start;
+
+        std::cout << "reopen: " << count << " messages in " << topic.getCommitLog(0)->segmentCount()
+                  << " segment files recovered in " << std::fixed << std::setprecision(1) << openMs.count()
+                  << " ms, heap +" << (heapAfterOpen - heapBefore) / 1024 << " KiB\n"
+                  << "history via pread, 64 per batch: " << std::setprecision(2)
+                  << count / readSeconds.count() / 1e6 << " M msgs/s (" << bytes / count << " B/msg)\n";
+    }
+
+    struct Drained {
+        size_t pushed;
+        size_t polled;
+        size_t grouped;
+    };
+
+    // Consumes a reopened topic from offset 0 with a push subscriber, a poller and a group
+    Drained drainReopened(KafkaSystem::KafkaController& controller, const std::string& topicId, size_t expected)
+    {
+        Drained drained{};
+        std::atomic<size_t> pushed{0};
+        std::atomic<size_t> grouped{0};
+        controller.subscribe(std::make_shared<CountingSubscriber>("pusher", std::chrono::microseconds(0), pushed), topicId);
+        controller.subscribe(std::make_shared<CountingSubscriber>("member", std::chrono::microseconds(0), grouped),
+                             topicId, "readers");
+        std::atomic<size_t> unused{0};
+        auto consumer = controller.subscribeForPolling(
+            std::make_shared<CountingSubscriber>("poller", std::chrono::microseconds(0), unused), topicId).front();
+        while (true) {
+            // 48 divides neither recovered count, so one poll straddles the disk/memory boundary
+            KafkaSystem::MessageBatch batch = consumer->poll(48, std::chrono::milliseconds(100));
+            if (batch.empty())
+                break;
+            drained.polled += batch.size();
+        }
+        for (int wait = 0; wait < 200 && (pushed.load(std::memory_order_acquire) < expected ||
+                                          grouped.load(std::memory_order_acquire) < expected); ++wait)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        drained.pushed = pushed.load(std::memory_order_acquire);
+        drained.grouped = grouped.load(std::memory_order_acquire);
+        return drained;
+    }
+
+    void printDrained(const std::string& what, const Drained& d, size_t expected)
+    {
+        std::cout << what << ": push " << d.pushed << ", poll " << d.polled << ", group " << d.grouped
+                  << " of " << expected
+                  << (d.pushed == expected && d.polled == expected && d.grouped == expected ? "" : "  <-- WRONG COUNT")
+                  << "\n";
+    }
+
+    // Reopens the durable topic, appends more and consumes everything.
+    // Batches that start on disk and end in memory must not lose their memory part.
+    void resumeAfterReopen(const KafkaSystem::CommitLogOptions& persistence, size_t appended)
+    {
+        Drained drained;
+        size_t total = 0;
+        {
+            QuietStdout quiet;
+            KafkaSystem::KafkaController controller(persistence);
+            auto topic = controller.createTopic("durable");
+            auto message = std::make_shared<KafkaSystem::Message>("after-reopen");
+            for (size_t i = 0; i < appended; ++i)
+                controller.publish(nullptr, topic->getTopicId(), message);
+            total = topic->getMessageCount(0);
+            drained = drainReopened(controller, topic->getTopicId(), total);
+            controller.shutdown();
+        }
+        printDrained("reopen + " + std::to_string(appended) + " appended", drained, total);
+    }
+
+    // Deletes the oldest segment file, as retention would, and reopens: consumers
+    // starting at offset 0 must skip to the first offset still on disk
+    void resumeAfterRetention(const std::filesystem::path& directory)
+    {
+        KafkaSystem::CommitLogOptions persistence;
+        persistence.directory = directory.string();
+        persistence.segmentBytes = 4096;
+        std::filesystem::remove_all(directory);
+        {
+            QuietStdout quiet;
+            KafkaSystem::KafkaController controller(persistence);
+            auto topic = controller.createTopic("retained");
+            auto message = std::make_shared<KafkaSystem::Message>("retained-payload-0123456789");
+            for (int i = 0; i < 2000; ++i)
+                controller.publish(nullptr, topic->getTopicId(), message);
+            controller.shutdown();
+        }
+        std::filesystem::remove(directory / "retained-0" / "00000000000000000000.log");
+        std::filesystem::remove(directory / "retained-0" / "00000000000000000000.index");
+
+        Drained drained;
+        uint64_t start = 0;
+        size_t expected = 0;
+        {
+            QuietStdout quiet;
+            KafkaSystem::KafkaController controller(persistence);
+            auto topic = controller.createTopic("retained");
+            start = topic->getStartOffset(0);
+            expected = topic->getMessageCount(0) - static_cast<size_t>(start);
+            drained = drainReopened(controller, topic->getTopicId(), expected);
+            controller.shutdown();
+        }
+        printDrained("first segment deleted, log starts at " + std::to_string(start), drained, expected);
+        std::filesystem::remove_all(directory);
+    }
+
+    void printRow(const char* name, const StorageResult& r)
+    {
+        std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.publishNs << std::setw(14) << r.readNs
+                  << std::setw(14) << r.bytesPerMessage << "\n";
+    }
+}
+
+int main()
+{
+    std::cout << "=== Topic storage ===\n";
+    for (size_t messages : { size_t(1000000), size_t(10000000) }) {
+        std::cout << "\n" << messages << " messages of ~32 bytes\n";
+        std::cout << std::left << std::setw(30) << "storage" << std::right
+                  << std::setw(14) << "publish ns" << std::setw(14) << "read ns"
+                  << std::setw(14) << "heap B/msg" << "\n";
+        printRow("vector<shared_ptr<Message>>", vectorTopic(messages));
+        printRow("SegmentedLog", segmentedTopic(messages));
+    }
+
+    const size_t messages = 4000;
+    const size_t keys = 64;
+    const auto handlerDelay = std::chrono::microseconds(100);
+    std::cout << "\n=== Partitions: one subscriber, " << messages << " keyed messages, "
+              << handlerDelay.count() << " us handler, hardware_concurrency = "
+              << std::thread::hardware_concurrency() << " ===\n";
+    std::cout << std::left << std::setw(14) << "partitions" << std::right
+              << std::setw(14) << "msgs/s" << std::setw(14) << "speedup" << std::setw(14) << "out of order" << "\n";
+    double base = 0;
+    for (size_t partitions : { 1, 2, 4, 8, 16 }) {
+        PartitionResult r = consumeWithPartitions(partitions, messages, keys, handlerDelay);
+        if (base == 0)
+            base = r.messagesPerSec;
+        std::cout << std::left << std::setw(14) << partitions << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.messagesPerSec << std::setw(13) << r.messagesPerSec / base << "x"
+                  << std::setw(14) << r.outOfOrder << "\n";
+    }
+
+    const size_t groupPartitions = 8;
+    std::cout << "\n=== Consumer group: " << groupPartitions << " partitions, " << messages << " messages, "
+              << handlerDelay.count() << " us handler ===\n";
+    std::cout << std::left << std::setw(14) << "members" << std::right
+              << std::setw(14) << "msgs/s" << std::setw(14) << "speedup" << "\n";
+    base = 0;
+    for (size_t members : { 1, 2, 4, 8 }) {
+        double rate = consumeWithGroup(members, groupPartitions, messages, handlerDelay);
+        if (base == 0)
+            base = rate;
+        std::cout << std::left << std::setw(14) << members << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << rate << std::setw(13) << rate / base << "x\n";
+    }
+
+    std::vector<KafkaSystem::Message> batchMessages;
+    for (size_t i = 0; i < 1000000; ++i)
+        batchMessages.emplace_back(payload(i));
+    std::cout << "\n=== Batched publish / poll: " << batchMessages.size() << " messages, 1 partition ===\n";
+    std::cout << std::left << std::setw(22) << "path" << std::right
+              << std::setw(16) << "publish M/s" << std::setw(16) << "end-to-end M/s" << std::setw(12) << "polls" << "\n";
+    for (size_t batch : { 0, 1, 16, 256 }) {
+        BatchResult r = batchThroughput(batchMessages, batch);
+        std::string name = batch == 0 ? "publish()" : "publishBatch x" + std::to_string(batch);
+        std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(16) << r.publishOnly << std::setw(16) << r.endToEnd << std::setw(12) << r.polls << "\n";
+    }
+
+    const size_t perProducer = 500000;
+    std::cout << "\n=== Multi-topic publish: one topic per producer thread, " << perProducer
+              << " messages each (M msgs/s) ===\n";
+    std::cout << std::left << std::setw(14) << "producers" << std::right
+              << std::setw(16) << "global lock" << std::setw(16) << "snapshot" << "\n";
+    for (size_t producers : { 1, 2, 4, 8 }) {
+        std::cout << std::left << std::setw(14) << producers << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(16) << multiTopicPublish(producers, perProducer, true)
+                  << std::setw(16) << multiTopicPublish(producers, perProducer, false) << "\n";
+    }
+
+    namespace fs = std::filesystem;
+    const fs::path dataDir = fs::temp_directory_path() / "kafka-benchmark-commit-log";
+    const size_t durableProducers = 4;
+    const size_t durableMessages = 200000;
+    std::cout << "\n=== Durable publish: " << durableProducers << " producers, " << durableMessages
+              << " messages, 1 partition, " << dataDir.string() << " ===\n";
+    std::cout << std::left << std::setw(22) << "fsync policy" << std::right
+              << std::setw(12) << "K msgs/s" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "max us" << std::setw(10) << "fsyncs" << "\n";
+    struct Policy { const char* name; size_t everyMessages; int intervalMs; bool durable; };
+    const Policy policies[] = {
+        { "in-memory", 0, 0, false },
+        { "never", 0, 0, true },
+        { "every 5 ms", 0, 5, true },
+        { "every 64 messages", 64, 0, true },
+        { "every message", 1, 0, true },
+    };
+    KafkaSystem::CommitLogOptions persistence;
+    persistence.directory = dataDir.string();
+    for (const Policy& policy : policies) {
+        fs::remove_all(dataDir);
+        persistence.fsyncEveryMessages = policy.everyMessages;
+        persistence.fsyncInterval = std::chrono::milliseconds(policy.intervalMs);
+        DurableResult r = durablePublish(policy.durable ? &persistence : nullptr, durableProducers, durableMessages);
+        std::cout << std::left << std::setw(22) << policy.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << r.messagesPerSec / 1e3 << std::setw(10) << r.p50Us
+                  << std::setw(10) << r.p99Us << std::setw(10) << r.maxUs << std::setw(10) << r.syncs << "\n";
+    }
+    recoverAndRead(persistence);
+    resumeAfterReopen(persistence, 1000);
+    resumeAfterRetention(fs::temp_directory_path() / "kafka-benchmark-retention");
+    fs::remove_all(dataDir);
+    return 0;
+}
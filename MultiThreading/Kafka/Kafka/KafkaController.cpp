@@ -3,22 +3,111 @@
 
 namespace KafkaSystem {
 
+    KafkaController::KafkaController()
+        : partitioner(std::make_shared<KeyHashPartitioner>()), topicIdCounter(0),
+          routing(nullptr), activePublishes(0), retiredCount(0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        publishRouting();
+    }
+
+    KafkaController::KafkaController(const CommitLogOptions& persistenceOptions)
+        : partitioner(std::make_shared<KeyHashPartitioner>()), persistence(persistenceOptions),
+          topicIdCounter(0), routing(nullptr), activePublishes(0), retiredCount(0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        publishRouting();
+    }
+
     KafkaController::~KafkaController() {
         shutdown();
     }
 
-    std::shared_ptr<Topic> KafkaController::createTopic(const std::string& topicName) {
+    void KafkaController::publishRouting() {
+        auto snapshot = std::make_unique<RoutingSnapshot>();
+        snapshot->partitioner = partitioner;
+
+        for (auto& topicPair : topics) {
+            TopicRoute& route = snapshot->routes[topicPair.first];
+            route.topic = topicPair.second;
+            route.controllersByPartition.resize(route.topic->getPartitionCount());
+            for (auto& controller : topicControllers[topicPair.first]) {
+                route.controllersByPartition[controller->getPartition()].push_back(controller);
+            }
+            for (auto& groupPair : consumerGroups[topicPair.first]) {
+                route.groups.push_back(groupPair.second);
+            }
+        }
+
+        // seq_cst: a publish that counts itself after this store sees the new snapshot
+        routing.store(snapshot.get());
+        if (currentRouting) retiredRouting.push_back(std::move(currentRouting));
+        currentRouting = std::move(snapshot);
+        retiredCount.store(retiredRouting.size());
+        freeRetiredRouting();
+    }
+
+    void KafkaController::freeRetiredRouting() {
+        // Nobody is inside publish, so nobody holds a snapshot replaced before now
+        if (!retiredRouting.empty() && activePublishes.load() == 0) {
+            retiredRouting.clear();
+            retiredCount.store(0);
+        }
+    }
+
+    KafkaController::RoutingReader::RoutingReader(KafkaController& owner) : controller(owner) {
+        controller.activePublishes.fetch_add(1);
+        current = controller.routing.load();
+    }
+
+    KafkaController::RoutingReader::~RoutingReader() {
+        // The last publish to leave frees what management calls could not; if mtx is
+        // busy, the next one to leave tries again
+        if (controller.activePublishes.fetch_sub(1) == 1 && controller.retiredCount.load() > 0) {
+            std::unique_lock<std::mutex> lock(controller.mtx, std::try_to_lock);
+            if (lock.owns_lock()) controller.freeRetiredRouting();
+        }
+    }
+
+    const KafkaController::TopicRoute& KafkaController::findRoute(const RoutingSnapshot& snapshot,
+                                                                  const std::string& topicId) const {
+        auto it = snapshot.routes.find(topicId);
+        if (it == snapshot.routes.end()) {
+            throw std::runtime_error("Topic with id " + topicId + " does not exist");
+        }
+        return it->second;
+    }
+
+    std::shared_ptr<Topic> KafkaController::createTopic(const std::string& topicName, size_t partitionCount) {
         std::lock_guard<std::mutex> lock(mtx);
 
+        // Durable topics are stored by name, so two of them cannot share one
+        if (persistence) {
+            for (auto& topicPair : topics) {
+                if (topicPair.second->getTopicName() == topicName) {
+                    throw std::runtime_error("Durable topic " + topicName + " already exists");
+                }
+            }
+        }
+
         std::string topicId = std::to_string(topicIdCounter.fetch_add(1) + 1);
-        auto topic = std::make_shared<Topic>(topicName, topicId);
+        auto topic = persistence
+            ? std::make_shared<Topic>(topicName, topicId, partitionCount, *persistence)
+            : std::make_shared<Topic>(topicName, topicId, partitionCount);
 
         topics[topicId] = topic;
         topicSubscribers[topicId] = std::vector<std::shared_ptr<TopicSubscriber>>();
         topicControllers[topicId] = std::vector<std::shared_ptr<TopicSubscriberController>>();
         subscriberThreads[topicId] = std::vector<std::thread>();
+        consumerGroups[topicId] = std::map<std::string, std::shared_ptr<ConsumerGroup>>();
+        publishRouting();
 
-        std::cout << "Created topic: " << topicName << " with id: " << topicId << std::endl;
+        std::cout << "Created topic: " << topicName << " with id: " << topicId;
+        if (topic->getPartitionCount() > 1) {
+            std::cout << " (" << topic->getPartitionCount() << " partitions)";
+        }
+        if (topic->isDurable() && topic->getMessageCount() > 0) {
+            std::cout << ", recovered " << topic->getMessageCount() << " messages";
+        }
+        std::cout << std::endl;
         return topic;
     }
 
@@ -33,41 +122,161 @@ namespace KafkaSystem {
 
         auto topic = topicIt->second;
         auto ts = std::make_shared<TopicSubscriber>(topic, subscriber);
-        auto controller = std::make_shared<TopicSubscriberController>(ts);
-
         topicSubscribers[topicId].push_back(ts);
-        topicControllers[topicId].push_back(controller);
 
-        // Start subscriber thread
-        subscriberThreads[topicId].emplace_back([controller]() {
-            controller->run();
-        });
+        // Start one subscriber thread per partition
+        for (size_t partition = 0; partition < topic->getPartitionCount(); ++partition) {
+            auto controller = std::make_shared<TopicSubscriberController>(ts, partition);
+            topicControllers[topicId].push_back(controller);
+
+            subscriberThreads[topicId].emplace_back([controller]() {
+                controller->run();
+            });
+        }
+        publishRouting();
 
         std::cout << "Subscriber " << subscriber->getId() << " subscribed to topic: " 
                   << topic->getTopicName() << std::endl;
     }
 
-    void KafkaController::publish(std::shared_ptr<IPublisher> publisher, 
-                                   const std::string& topicId, 
-                                   std::shared_ptr<Message> message) {
+    std::vector<std::shared_ptr<TopicSubscriberController>> KafkaController::subscribeForPolling(
+        std::shared_ptr<ISubscriber> subscriber, const std::string& topicId) {
         std::lock_guard<std::mutex> lock(mtx);
 
+        std::vector<std::shared_ptr<TopicSubscriberController>> controllers;
         auto topicIt = topics.find(topicId);
         if (topicIt == topics.end()) {
-            throw std::runtime_error("Topic with id " + topicId + " does not exist");
+            std::cerr << "Topic with id " << topicId << " does not exist" << std::endl;
+            return controllers;
         }
 
         auto topic = topicIt->second;
-        topic->addMessage(message);
+        auto ts = std::make_shared<TopicSubscriber>(topic, subscriber);
+        topicSubscribers[topicId].push_back(ts);
 
-        // Notify all subscribers of this topic
-        auto& controllers = topicControllers[topicId];
-        for (auto& controller : controllers) {
-            controller->notifyNewMessage();
+        for (size_t partition = 0; partition < topic->getPartitionCount(); ++partition) {
+            auto controller = std::make_shared<TopicSubscriberController>(ts, partition);
+            topicControllers[topicId].push_back(controller);
+            controllers.push_back(controller);
         }
+        publishRouting();
 
-        std::cout << "Message \"" << message->getContent() << "\" published to topic: " 
+        std::cout << "Subscriber " << subscriber->getId() << " subscribed for polling to topic: "
                   << topic->getTopicName() << std::endl;
+        return controllers;
+    }
+
+    void KafkaController::subscribe(std::shared_ptr<ISubscriber> subscriber, const std::string& topicId,
+                                    const std::string& groupId, AssignmentStrategy strategy) {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        auto topicIt = topics.find(topicId);
+        if (topicIt == topics.end()) {
+            std::cerr << "Topic with id " << topicId << " does not exist" << std::endl;
+            return;
+        }
+
+        auto& group = consumerGroups[topicId][groupId];
+        if (!group) {
+            group = std::make_shared<ConsumerGroup>(groupId, topicIt->second, strategy);
+            publishRouting();
+        }
+
+        if (!group->join(subscriber)) {
+            std::cerr << "Subscriber " << subscriber->getId() << " is already in group " << groupId << std::endl;
+            return;
+        }
+
+        std::cout << "Subscriber " << subscriber->getId() << " joined group " << groupId
+                  << " on topic: " << topicIt->second->getTopicName() << std::endl;
+    }
+
+    void KafkaController::unsubscribe(const std::string& topicId, const std::string& groupId,
+                                      const std::string& subscriberId) {
+        std::shared_ptr<ConsumerGroup> group = getConsumerGroup(topicId, groupId);
+        if (!group) {
+            std::cerr << "Group " << groupId << " does not exist on topic " << topicId << std::endl;
+            return;
+        }
+
+        // Outside mtx: leave() waits for the member's in-flight message
+        if (group->leave(subscriberId)) {
+            std::cout << "Subscriber " << subscriberId << " left group " << groupId << std::endl;
+        }
+    }
+
+    std::shared_ptr<ConsumerGroup> KafkaController::getConsumerGroup(const std::string& topicId,
+                                                                      const std::string& groupId) {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        auto topicIt = consumerGroups.find(topicId);
+        if (topicIt == consumerGroups.end()) return nullptr;
+        auto groupIt = topicIt->second.find(groupId);
+        return groupIt == topicIt->second.end() ? nullptr : groupIt->second;
+    }
+
+    void KafkaController::publish(std::shared_ptr<IPublisher> publisher, 
+                                   const std::string& topicId, 
+                                   std::shared_ptr<Message> message) {
+        // No controller lock and no reference counting: the reader keeps the snapshot alive
+        RoutingReader reader(*this);
+        const RoutingSnapshot& snapshot = reader.snapshot();
+        const TopicRoute& route = findRoute(snapshot, topicId);
+
+        size_t partitionCount = route.topic->getPartitionCount();
+        size_t partition = partitionCount == 1 ? 0 : snapshot.partitioner->partition(*message, partitionCount);
+        route.topic->addMessage(partition, message->getContent());
+
+        // Notify the subscribers consuming this partition
+        for (auto& controller : route.controllersByPartition[partition]) {
+            controller->notifyNewMessage();
+        }
+        for (auto& group : route.groups) {
+            group->notifyNewMessage();
+        }
+    }
+
+    void KafkaController::publishBatch(const std::string& topicId, const Message* messages, size_t count) {
+        RoutingReader reader(*this);
+        const RoutingSnapshot& snapshot = reader.snapshot();
+        const TopicRoute& route = findRoute(snapshot, topicId);
+        if (count == 0) return;
+
+        // Route every message first, then append each partition's run in one go
+        auto& topic = route.topic;
+        size_t partitionCount = topic->getPartitionCount();
+        std::vector<std::vector<std::string_view>> byPartition(partitionCount);
+        if (partitionCount == 1) byPartition[0].reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            size_t partition = partitionCount == 1 ? 0 : snapshot.partitioner->partition(messages[i], partitionCount);
+            byPartition[partition].push_back(messages[i].getContent());
+        }
+        for (size_t partition = 0; partition < partitionCount; ++partition) {
+            if (!byPartition[partition].empty()) {
+                topic->addMessages(partition, byPartition[partition].data(), byPartition[partition].size());
+            }
+        }
+
+        // One wakeup per consumer that has new messages
+        for (size_t partition = 0; partition < partitionCount; ++partition) {
+            if (byPartition[partition].empty()) continue;
+            for (auto& controller : route.controllersByPartition[partition]) {
+                controller->notifyNewMessage();
+            }
+        }
+        for (auto& group : route.groups) {
+            group->notifyNewMessage();
+        }
+    }
+
+    void KafkaController::publishBatch(const std::string& topicId, const std::vector<Message>& messages) {
+        publishBatch(topicId, messages.data(), messages.size());
+    }
+
+    void KafkaController::setPartitioner(std::shared_ptr<IPartitioner> newPartitioner) {
+        std::lock_guard<std::mutex> lock(mtx);
+        partitioner = newPartitioner;
+        publishRouting();
     }
 
     void KafkaController::resetOffset(const std::string& topicId, 
@@ -88,7 +297,9 @@ namespace KafkaSystem {
             if (subscribers[i]->getSubscriber()->getId() == subscriberId) {
                 subscribers[i]->setOffset(newOffset);
                 /*When you reset a subscriber's offset (e.g., from 5 back to 0), the subscriber thread might be waiting (blocked) because it thinks it has consumed all messages.*/
-                controllers[i]->notifyNewMessage();
+                for (auto& controller : controllers) {
+                    controller->notifyNewMessage();
+                }
 
                 std::cout << "Offset for subscriber " << subscriberId << " on topic " 
                           << subscribers[i]->getTopic()->getTopicName() 
@@ -98,6 +309,43 @@ namespace KafkaSystem {
         }
     }
 
+    void KafkaController::resetOffset(const std::string& topicId,
+                                       const std::string& subscriberId,
+                                       size_t partition,
+                                       int newOffset) {
+        std::lock_guard<std::mutex> lock(mtx);
+
+        auto subsIt = topicSubscribers.find(topicId);
+        if (subsIt == topicSubscribers.end()) {
+            std::cerr << "Topic with id " << topicId << " does not exist" << std::endl;
+            return;
+        }
+
+        auto& subscribers = subsIt->second;
+        auto& controllers = topicControllers[topicId];
+
+        for (size_t i = 0; i < subscribers.size(); ++i) {
+            if (subscribers[i]->getSubscriber()->getId() == subscriberId) {
+                if (partition >= subscribers[i]->getTopic()->getPartitionCount()) {
+                    std::cerr << "Topic with id " << topicId << " has no partition " << partition << std::endl;
+                    return;
+                }
+                subscribers[i]->setOffset(partition, newOffset);
+                for (auto& controller : controllers) {
+                    if (controller->getPartition() == partition) {
+                        controller->notifyNewMessage();
+                    }
+                }
+
+                std::cout << "Offset for subscriber " << subscriberId << " on topic "
+                          << subscribers[i]->getTopic()->getTopicName()
+                          << " partition " << partition
+                          << " reset to " << newOffset << std::endl;
+                break;
+            }
+        }
+    }
+
     void KafkaController::shutdown() {
         std::lock_guard<std::mutex> lock(mtx);
 
@@ -108,6 +356,13 @@ namespace KafkaSystem {
             }
         }
 
+        // Stop consumer groups (joins their member threads)
+        for (auto& topicGroupsPair : consumerGroups) {
+            for (auto& groupPair : topicGroupsPair.second) {
+                groupPair.second->stop();
+            }
+        }
+
         // Join all threads
         for (auto& threadVecPair : subscriberThreads) {
             for (auto& thread : threadVecPair.second) {
@@ -4,42 +4,116 @@
 #include "ISubscriber.h"
 #include "TopicSubscriber.h"
 #include "TopicSubscriberController.h"
+#include "Partitioner.h"
+#include "ConsumerGroup.h"
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <optional>
 
 namespace KafkaSystem {
 
     // KafkaController - Central manager for the pub-sub system
+    // mtx guards the maps below and is taken by topic/subscription management
+    // only. publish() never takes it: it reads an immutable RoutingSnapshot
+    // that those calls rebuild and swap in, so publishers to different topics
+    // share no lock (appends lock only their own partition).
     class KafkaController {
     private:
+        // Everything publish() needs to deliver to one topic
+        struct TopicRoute {
+            std::shared_ptr<Topic> topic;
+            std::vector<std::vector<std::shared_ptr<TopicSubscriberController>>> controllersByPartition;
+            std::vector<std::shared_ptr<ConsumerGroup>> groups;
+        };
+
+        struct RoutingSnapshot {
+            std::unordered_map<std::string, TopicRoute> routes;
+            std::shared_ptr<IPartitioner> partitioner;
+        };
+
         std::map<std::string, std::shared_ptr<Topic>> topics;
         std::map<std::string, std::vector<std::shared_ptr<TopicSubscriber>>> topicSubscribers;
         std::map<std::string, std::vector<std::shared_ptr<TopicSubscriberController>>> topicControllers;
         std::map<std::string, std::vector<std::thread>> subscriberThreads;
+        std::map<std::string, std::map<std::string, std::shared_ptr<ConsumerGroup>>> consumerGroups;
+
+        std::shared_ptr<IPartitioner> partitioner;
+        std::optional<CommitLogOptions> persistence;    // set: every topic is durable
 
         std::mutex mtx;
         std::atomic<int> topicIdCounter;
 
+        // Current snapshot, read with one atomic load. Every publish call counts
+        // itself in activePublishes while it may hold a snapshot; a replaced one
+        // waits in retiredRouting until a moment when that count is zero, which
+        // the next management call or the last publish to leave checks for.
+        std::atomic<const RoutingSnapshot*> routing;
+        std::atomic<int> activePublishes;
+        std::atomic<size_t> retiredCount;
+        std::unique_ptr<const RoutingSnapshot> currentRouting;                  // guarded by mtx
+        std::vector<std::unique_ptr<const RoutingSnapshot>> retiredRouting;     // guarded by mtx
+
+        // Pins the current snapshot for one publish call
+        class RoutingReader {
+        public:
+            explicit RoutingReader(KafkaController& controller);
+            ~RoutingReader();
+            const RoutingSnapshot& snapshot() const { return *current; }
+
+        private:
+            KafkaController& controller;
+            const RoutingSnapshot* current;
+        };
+
+        void publishRouting();    // called with mtx held
+        void freeRetiredRouting();  // called with mtx held
+        const TopicRoute& findRoute(const RoutingSnapshot& snapshot, const std::string& topicId) const;
+
     public:
-        KafkaController() : topicIdCounter(0) {}
+        KafkaController();
+        // Durable controller: topics are persisted under persistence.directory
+        // and a topic created with the name of an earlier run's topic reopens its log
+        explicit KafkaController(const CommitLogOptions& persistence);
         ~KafkaController();
 
         // Topic management
-        std::shared_ptr<Topic> createTopic(const std::string& topicName);
+        std::shared_ptr<Topic> createTopic(const std::string& topicName, size_t partitionCount = 1);
 
-        // Subscription management
+        // Subscription management: one consumer thread per partition of the topic,
+        // so onMessage may be called concurrently for different partitions
         void subscribe(std::shared_ptr<ISubscriber> subscriber, const std::string& topicId);
 
-        // Publishing
+        // Pull-style subscription: no threads are started; the caller polls the
+        // returned controllers (one per partition) with poll(maxMessages, timeout)
+        std::vector<std::shared_ptr<TopicSubscriberController>> subscribeForPolling(
+            std::shared_ptr<ISubscriber> subscriber, const std::string& topicId);
+
+        // Consumer groups: members with the same groupId split the topic's partitions
+        // between them; joining or leaving rebalances the group. The first member
+        // fixes the group's assignment strategy.
+        void subscribe(std::shared_ptr<ISubscriber> subscriber, const std::string& topicId,
+                      const std::string& groupId, AssignmentStrategy strategy = AssignmentStrategy::Range);
+        void unsubscribe(const std::string& topicId, const std::string& groupId, const std::string& subscriberId);
+        std::shared_ptr<ConsumerGroup> getConsumerGroup(const std::string& topicId, const std::string& groupId);
+
+        // Publishing: the partitioner picks the partition (key hash by default)
         void publish(std::shared_ptr<IPublisher> publisher, const std::string& topicId, 
                     std::shared_ptr<Message> message);
+        void setPartitioner(std::shared_ptr<IPartitioner> newPartitioner);
+
+        // Batched publishing: one lookup, one append per partition and one wakeup
+        // per affected consumer for the whole batch
+        void publishBatch(const std::string& topicId, const Message* messages, size_t count);
+        void publishBatch(const std::string& topicId, const std::vector<Message>& messages);
 
-        // Offset management
+        // Offset management: every partition, or a single one
         void resetOffset(const std::string& topicId, const std::string& subscriberId, int newOffset);
+        void resetOffset(const std::string& topicId, const std::string& subscriberId, size_t partition, int newOffset);
 
         // Shutdown
         void shutdown();
@@ -14,9 +14,9 @@ int main() {
 
     KafkaController kafkaController;
 
-    // Create topics
+    // Create topics: Topic2 is split into 2 partitions consumed in parallel
     auto topic1 = kafkaController.createTopic("Topic1");
-    auto topic2 = kafkaController.createTopic("Topic2");
+    auto topic2 = kafkaController.createTopic("Topic2", 2);
 
     std::cout << std::endl;
 
@@ -43,15 +43,18 @@ int main() {
     // Publish some messages
     publisher1.publish(topic1->getTopicId(), std::make_shared<Message>("Message m1"));
     publisher1.publish(topic1->getTopicId(), std::make_shared<Message>("Message m2"));
-    publisher2.publish(topic2->getTopicId(), std::make_shared<Message>("Message m3"));
+    // Keyed messages: the same key always lands in the same partition, so
+    // per-key order is kept even though partitions are consumed in parallel
+    publisher2.publish(topic2->getTopicId(), std::make_shared<Message>("user-42", "Message m3"));
 
     // Allow time for subscribers to process messages
     std::this_thread::sleep_for(std::chrono::seconds(3));
 
     std::cout << "\n--- Publishing More Messages ---\n" << std::endl;
 
-    publisher2.publish(topic2->getTopicId(), std::make_shared<Message>("Message m4"));
+    publisher2.publish(topic2->getTopicId(), std::make_shared<Message>("user-42", "Message m4"));
     publisher1.publish(topic1->getTopicId(), std::make_shared<Message>("Message m5"));
+    publisher2.publish(topic2->getTopicId(), std::make_shared<Message>("user-7", "Message m6"));
 
     std::this_thread::sleep_for(std::chrono::seconds(2));
 
@@ -60,9 +63,41 @@ int main() {
     // Reset offset for subscriber1 on topic1 (re-process messages)
     kafkaController.resetOffset(topic1->getTopicId(), subscriber1->getId(), 0);
 
-    // Allow some time before shutting down
+    // Allow some time before the next section
     std::this_thread::sleep_for(std::chrono::seconds(3));
 
+    std::cout << "\n--- Consumer Group (4 partitions, sticky assignment) ---\n" << std::endl;
+
+    // Members of group "billing" split the partitions: each order is handled once
+    auto orders = kafkaController.createTopic("Orders", 4);
+    auto workerA = std::make_shared<SimpleSubscriber>("WorkerA");
+    auto workerB = std::make_shared<SimpleSubscriber>("WorkerB");
+    auto workerC = std::make_shared<SimpleSubscriber>("WorkerC");
+    kafkaController.subscribe(workerA, orders->getTopicId(), "billing", AssignmentStrategy::Sticky);
+    kafkaController.subscribe(workerB, orders->getTopicId(), "billing", AssignmentStrategy::Sticky);
+
+    for (int i = 1; i <= 4; ++i) {
+        publisher1.publish(orders->getTopicId(),
+                           std::make_shared<Message>("order-" + std::to_string(i), "Order o" + std::to_string(i)));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+
+    // A third member joins: partitions are rebalanced, committed offsets carry over
+    kafkaController.subscribe(workerC, orders->getTopicId(), "billing");
+    for (int i = 5; i <= 8; ++i) {
+        publisher1.publish(orders->getTopicId(),
+                           std::make_shared<Message>("order-" + std::to_string(i), "Order o" + std::to_string(i)));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+
+    // WorkerA leaves: its partitions move to the remaining members
+    kafkaController.unsubscribe(orders->getTopicId(), "billing", workerA->getId());
+    for (int i = 9; i <= 10; ++i) {
+        publisher1.publish(orders->getTopicId(),
+                           std::make_shared<Message>("order-" + std::to_string(i), "Order o" + std::to_string(i)));
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+
     std::cout << "\n--- Shutting Down ---\n" << std::endl;
     kafkaController.shutdown();
 
@@ -1,19 +1,44 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <memory>
 
 namespace KafkaSystem {
 
     // Message class - represents a message in the pub-sub system
+    // The optional key picks the partition: messages with the same key land in
+    // the same partition and are therefore consumed in publish order.
     class Message {
     private:
         std::string content;
+        std::string key;
 
     public:
         explicit Message(const std::string& msg) : content(msg) {}
+        Message(const std::string& messageKey, const std::string& msg) : content(msg), key(messageKey) {}
 
-        std::string getContent() const { return content; }
+        const std::string& getContent() const { return content; }
+        const std::string& getKey() const { return key; }
+        bool hasKey() const { return !key.empty(); }
     };
 
-} // namespace KafkaSystem
+    // MessageView - a stored message as handed to subscribers
+    // content points into the topic's log segment, so it is only valid while
+    // the Topic is alive; copy it out to keep it longer.
+    class MessageView {
+    private:
+        size_t partition;
+        uint64_t offset;
+        std::string_view content;
+
+    public:
+        MessageView(size_t messagePartition, uint64_t messageOffset, std::string_view messageContent)
+            : partition(messagePartition), offset(messageOffset), content(messageContent) {}
 
+        size_t getPartition() const { return partition; }
+        uint64_t getOffset() const { return offset; }
+        std::string_view getContent() const { return content; }
+    };
+
+} // namespace KafkaSystem
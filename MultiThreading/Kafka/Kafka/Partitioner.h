@@ -0,0 +1,52 @@
+#pragma once
+#include "Message.h"
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace KafkaSystem {
+
+    // IPartitioner Interface - picks the partition a published message goes to
+    class IPartitioner {
+    public:
+        virtual ~IPartitioner() = default;
+        virtual size_t partition(const Message& message, size_t partitionCount) = 0;
+    };
+
+    // KeyHashPartitioner - same key, same partition; keyless messages round-robin
+    // Uses FNV-1a rather than std::hash so the key -> partition mapping does not
+    // change between builds or standard libraries.
+    class KeyHashPartitioner : public IPartitioner {
+    private:
+        std::atomic<size_t> next{0};
+
+    public:
+        static uint32_t hash(std::string_view key) {
+            uint32_t h = 2166136261u;
+            for (unsigned char c : key) {
+                h ^= c;
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        size_t partition(const Message& message, size_t partitionCount) override {
+            if (message.hasKey()) {
+                return hash(message.getKey()) % partitionCount;
+            }
+            return next.fetch_add(1, std::memory_order_relaxed) % partitionCount;
+        }
+    };
+
+    // RoundRobinPartitioner - spreads every message evenly and ignores keys
+    class RoundRobinPartitioner : public IPartitioner {
+    private:
+        std::atomic<size_t> next{0};
+
+    public:
+        size_t partition(const Message&, size_t partitionCount) override {
+            return next.fetch_add(1, std::memory_order_relaxed) % partitionCount;
+        }
+    };
+
+} // namespace KafkaSystem
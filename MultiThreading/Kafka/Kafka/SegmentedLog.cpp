@@ -0,0 +1,72 @@
+#include "SegmentedLog.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace KafkaSystem {
+
+    SegmentedLog::SegmentedLog(size_t segmentBytes, uint64_t baseOffset)
+        : segmentBytes(std::min<size_t>(std::max<size_t>(segmentBytes, 64), 0xFFFFFFFFu)),
+          baseOffset(baseOffset), endOffset(baseOffset) {}
+
+    void SegmentedLog::openSegment(size_t minBytes) {
+        size_t capacity = std::max(segmentBytes, minBytes);
+        segments.push_back(std::unique_ptr<char[]>(new char[capacity]));
+        current = segments[segments.size() - 1].get();
+        currentUsed = 0;
+        currentCapacity = capacity;
+        allocatedSegmentBytes += capacity;
+    }
+
+    uint64_t SegmentedLog::append(std::string_view record) {
+        return appendBatch(&record, 1);
+    }
+
+    uint64_t SegmentedLog::appendBatch(const std::string_view* records, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            if (records[i].size() > 0xFFFFFFFFu) {
+                throw std::length_error("Record larger than 4 GiB");
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(appendMtx);
+
+        uint64_t first = baseOffset + index.size();
+        for (size_t i = 0; i < count; ++i) {
+            appendLocked(records[i]);
+        }
+
+        // Publishes the record bytes and index entries to lock-free readers
+        if (count > 0) {
+            endOffset.store(baseOffset + index.size(), std::memory_order_release);
+        }
+        return first;
+    }
+
+    void SegmentedLog::appendLocked(std::string_view record) {
+        size_t needed = LengthBytes + record.size();
+        if (!current || currentCapacity - currentUsed < needed) {
+            openSegment(needed);
+        }
+
+        char* slot = current + currentUsed;
+        uint32_t length = static_cast<uint32_t>(record.size());
+        std::memcpy(slot, &length, LengthBytes);
+        std::memcpy(slot + LengthBytes, record.data(), record.size());
+
+        uint64_t location = (uint64_t(segments.size() - 1) << 32) | currentUsed;
+        currentUsed += needed;
+
+        index.push_back(location);
+    }
+
+    size_t SegmentedLog::segmentCount() const {
+        std::lock_guard<std::mutex> lock(appendMtx);
+        return segments.size();
+    }
+
+    size_t SegmentedLog::memoryUsage() const {
+        std::lock_guard<std::mutex> lock(appendMtx);
+        return allocatedSegmentBytes + index.allocatedBytes() + segments.allocatedBytes();
+    }
+
+} // namespace KafkaSystem
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace KafkaSystem {
+
+    // AppendOnlyArray - grow-only array whose elements never move
+    // One writer appends; readers index concurrently without a lock. Storage is
+    // a list of chunks that double in size (chunk k holds FirstChunk << k
+    // elements), so growing never copies and an index maps to its chunk with a
+    // bit scan. The owner publishes the element count, this class does not.
+    template<typename T>
+    class AppendOnlyArray {
+    private:
+        static constexpr size_t FirstChunkShift = 10;
+        static constexpr size_t FirstChunk = size_t(1) << FirstChunkShift;
+        static constexpr size_t MaxChunks = 40;
+
+        std::atomic<T*> chunks[MaxChunks] = {};
+        size_t count = 0;     // writer only
+
+        static void locate(size_t index, size_t& chunk, size_t& slot) {
+            size_t biased = (index >> FirstChunkShift) + 1;
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanReverse64(&bit, biased);
+            chunk = bit;
+#else
+            chunk = sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(biased);
+#endif
+            slot = index - ((FirstChunk << chunk) - FirstChunk);
+        }
+
+    public:
+        AppendOnlyArray() = default;
+        AppendOnlyArray(const AppendOnlyArray&) = delete;
+        AppendOnlyArray& operator=(const AppendOnlyArray&) = delete;
+
+        ~AppendOnlyArray() {
+            for (auto& chunk : chunks) {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+
+        void push_back(T value) {
+            size_t chunk, slot;
+            locate(count, chunk, slot);
+            T* storage = chunks[chunk].load(std::memory_order_relaxed);
+            if (!storage) {
+                storage = new T[FirstChunk << chunk]();
+                chunks[chunk].store(storage, std::memory_order_release);
+            }
+            storage[slot] = std::move(value);
+            ++count;
+        }
+
+        // index must be below a count the writer has already published
+        const T& operator[](size_t index) const {
+            size_t chunk, slot;
+            locate(index, chunk, slot);
+            return chunks[chunk].load(std::memory_order_acquire)[slot];
+        }
+
+        T& operator[](size_t index) {
+            size_t chunk, slot;
+            locate(index, chunk, slot);
+            return chunks[chunk].load(std::memory_order_acquire)[slot];
+        }
+
+        size_t size() const { return count; }
+
+        size_t allocatedBytes() const {
+            size_t bytes = 0;
+            for (size_t k = 0; k < MaxChunks; ++k) {
+                if (chunks[k].load(std::memory_order_relaxed))
+                    bytes += (FirstChunk << k) * sizeof(T);
+            }
+            return bytes;
+        }
+    };
+
+    // SegmentedLog - append-only record store backing a Topic
+    // Records are packed into fixed-size byte segments as a 4-byte length
+    // followed by the payload; a record bigger than a segment gets a segment
+    // of its own. The offset index holds one packed (segment, position) word
+    // per record. Segments and index entries never move or get freed while
+    // the log lives, so read() hands out string_views into the segment with
+    // no copy, no lock and no reference count. Appends are serialized by a
+    // mutex and become visible to readers through one release store of the
+    // record count. Offsets start at baseOffset, which lets a durable topic
+    // keep only the records appended since it was reopened in memory.
+    class SegmentedLog {
+    public:
+        static constexpr size_t DefaultSegmentBytes = 1 << 20;
+
+        explicit SegmentedLog(size_t segmentBytes = DefaultSegmentBytes, uint64_t baseOffset = 0);
+
+        SegmentedLog(const SegmentedLog&) = delete;
+        SegmentedLog& operator=(const SegmentedLog&) = delete;
+
+        // Thread-safe; returns the offset of the new record
+        uint64_t append(std::string_view record);
+
+        // Appends count records under one lock and publishes them with one
+        // release store; returns the offset of the first
+        uint64_t appendBatch(const std::string_view* records, size_t count);
+
+        // End offset; read(offset) is valid for getBaseOffset() <= offset < size()
+        uint64_t size() const { return endOffset.load(std::memory_order_acquire); }
+        uint64_t getBaseOffset() const { return baseOffset; }
+
+        // View into the segment; stays valid for the lifetime of the log
+        std::string_view read(uint64_t offset) const {
+            uint64_t location = index[offset - baseOffset];
+            const char* record = segments[location >> 32].get() + (location & 0xFFFFFFFFu);
+            uint32_t length;
+            std::memcpy(&length, record, sizeof(length));
+            return std::string_view(record + sizeof(length), length);
+        }
+
+        size_t segmentCount() const;
+        size_t memoryUsage() const;   // segment bytes + index bytes
+
+    private:
+        static constexpr size_t LengthBytes = sizeof(uint32_t);
+
+        void openSegment(size_t minBytes);
+        void appendLocked(std::string_view record);
+
+        const size_t segmentBytes;
+        const uint64_t baseOffset;
+
+        AppendOnlyArray<std::unique_ptr<char[]>> segments;
+        AppendOnlyArray<uint64_t> index;
+
+        // Writer state, guarded by appendMtx
+        mutable std::mutex appendMtx;
+        char* current = nullptr;
+        size_t currentUsed = 0;
+        size_t currentCapacity = 0;
+        size_t allocatedSegmentBytes = 0;
+
+        std::atomic<uint64_t> endOffset{0};
+    };
+
+} // namespace KafkaSystem
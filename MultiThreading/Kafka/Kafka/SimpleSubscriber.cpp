@@ -3,9 +3,12 @@
 
 namespace KafkaSystem {
 
-    void SimpleSubscriber::onMessage(std::shared_ptr<Message> message) {
+    void SimpleSubscriber::onMessage(const MessageView& message) {
         // Processing the received message
-        std::cout << "Subscriber " << id << " received: " << message->getContent() << std::endl;
+        {
+            std::lock_guard<std::mutex> lock(printMtx);
+            std::cout << "Subscriber " << id << " received: " << message.getContent() << std::endl;
+        }
 
         // Simulate processing delay
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -3,6 +3,7 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <mutex>
 
 namespace KafkaSystem {
 
@@ -10,13 +11,14 @@ namespace KafkaSystem {
     class SimpleSubscriber : public ISubscriber {
     private:
         std::string id;
+        std::mutex printMtx;    // partitions of one subscription are consumed in parallel
 
     public:
         explicit SimpleSubscriber(const std::string& subscriberId) : id(subscriberId) {}
 
         std::string getId() const override { return id; }
 
-        void onMessage(std::shared_ptr<Message> message) override;
+        void onMessage(const MessageView& message) override;
     };
 
 } // namespace KafkaSystem
@@ -0,0 +1,94 @@
+#include "Topic.h"
+#include <algorithm>
+#include <iostream>
+
+namespace KafkaSystem {
+
+    Topic::Topic(const std::string& name, const std::string& id, size_t partitionCount, size_t segmentBytes)
+        : topicName(name), topicId(id) {
+        if (partitionCount == 0) partitionCount = 1;
+        for (size_t i = 0; i < partitionCount; ++i) {
+            auto partition = std::make_unique<Partition>();
+            partition->log = std::make_unique<SegmentedLog>(segmentBytes);
+            partitions.push_back(std::move(partition));
+        }
+    }
+
+    Topic::Topic(const std::string& name, const std::string& id, size_t partitionCount,
+                 const CommitLogOptions& persistence)
+        : topicName(name), topicId(id) {
+        if (partitionCount == 0) partitionCount = 1;
+        for (size_t i = 0; i < partitionCount; ++i) {
+            auto partition = std::make_unique<Partition>();
+            partition->disk = std::make_unique<CommitLog>(
+                persistence.directory + "/" + name + "-" + std::to_string(i), persistence);
+            partition->log = std::make_unique<SegmentedLog>(SegmentedLog::DefaultSegmentBytes,
+                                                            partition->disk->getEndOffset());
+            partitions.push_back(std::move(partition));
+        }
+
+        if (persistence.fsyncInterval.count() > 0) {
+            flusher = std::thread([this, interval = persistence.fsyncInterval]() { runFlusher(interval); });
+        }
+    }
+
+    Topic::~Topic() {
+        {
+            std::lock_guard<std::mutex> lock(flusherMtx);
+            stopping = true;
+        }
+        flusherCv.notify_all();
+        if (flusher.joinable()) flusher.join();
+    }
+
+    void Topic::runFlusher(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(flusherMtx);
+        while (!flusherCv.wait_for(lock, interval, [this]() { return stopping; })) {
+            lock.unlock();
+            for (auto& partition : partitions) {
+                try {
+                    partition->disk->sync();
+                }
+                catch (const std::exception& e) {
+                    // The partition is offline now; its next append reports it to the publisher
+                    std::cerr << e.what() << std::endl;
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    uint64_t Topic::addMessages(size_t partition, const std::string_view* contents, size_t count) {
+        Partition& p = *partitions[partition];
+        if (!p.disk) {
+            return p.log->appendBatch(contents, count);
+        }
+
+        uint64_t first;
+        bool syncDue;
+        {
+            std::lock_guard<std::mutex> lock(p.appendMtx);
+            syncDue = p.disk->append(contents, count);
+            first = p.log->appendBatch(contents, count);
+        }
+        if (syncDue) p.disk->sync();
+        return first;
+    }
+
+    MessageBatch Topic::getMessages(size_t partition, size_t fromOffset, size_t maxCount) const {
+        const Partition& p = *partitions[partition];
+        size_t available = getMessageCount(partition);
+        if (fromOffset >= available || fromOffset < getStartOffset(partition)) return MessageBatch();
+
+        // Offsets from before the topic was reopened are only on disk
+        uint64_t memoryStart = p.log->getBaseOffset();
+        if (fromOffset < memoryStart) {
+            size_t count = static_cast<size_t>(std::min<uint64_t>(maxCount, memoryStart - fromOffset));
+            return MessageBatch(p.disk->read(fromOffset, count), partition);
+        }
+
+        size_t count = available - fromOffset < maxCount ? available - fromOffset : maxCount;
+        return MessageBatch(p.log.get(), partition, fromOffset, count);
+    }
+
+} // namespace KafkaSystem
@@ -1,50 +1,150 @@
 #pragma once
 #include "Message.h"
+#include "SegmentedLog.h"
+#include "CommitLog.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <mutex>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace KafkaSystem {
 
-    // Topic class - maintains list of messages published to this topic
+    // MessageBatch - a contiguous run of offsets from one partition
+    // Holds no copies: indexing reads straight from the partition log, so the
+    // batch (like MessageView) is only valid while its Topic is alive. History
+    // read back from a CommitLog is the exception; that batch owns its records.
+    class MessageBatch {
+    private:
+        const SegmentedLog* log = nullptr;
+        std::shared_ptr<const StoredRecords> stored;
+        size_t partition = 0;
+        uint64_t firstOffset = 0;
+        size_t count = 0;
+
+    public:
+        class Iterator {
+        private:
+            const MessageBatch* batch;
+            size_t position;
+
+        public:
+            Iterator(const MessageBatch* b, size_t pos) : batch(b), position(pos) {}
+            MessageView operator*() const { return (*batch)[position]; }
+            Iterator& operator++() { ++position; return *this; }
+            bool operator!=(const Iterator& other) const { return position != other.position; }
+        };
+
+        MessageBatch() = default;
+        MessageBatch(const SegmentedLog* partitionLog, size_t partitionIndex, uint64_t first, size_t size)
+            : log(partitionLog), partition(partitionIndex), firstOffset(first), count(size) {}
+        MessageBatch(std::shared_ptr<const StoredRecords> records, size_t partitionIndex)
+            : stored(std::move(records)), partition(partitionIndex),
+              firstOffset(stored->firstOffset), count(stored->records.size()) {}
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_t getPartition() const { return partition; }
+        uint64_t getFirstOffset() const { return firstOffset; }
+
+        MessageView operator[](size_t i) const {
+            if (stored) return MessageView(partition, firstOffset + i, stored->records[i]);
+            return MessageView(partition, firstOffset + i, log->read(firstOffset + i));
+        }
+
+        Iterator begin() const { return Iterator(this, 0); }
+        Iterator end() const { return Iterator(this, count); }
+    };
+
+    // Topic class - maintains the partitioned log of messages published to this topic
+    // Each partition is its own SegmentedLog with its own offsets, so ordering
+    // is per partition and partitions can be consumed in parallel. The
+    // partition count is fixed when the topic is created. A durable topic also
+    // writes every partition through to a CommitLog under
+    // <directory>/<topic name>-<partition>; reopened, its in-memory logs start
+    // at the recovered end offsets and older offsets are read from disk.
     class Topic {
     private:
+        struct Partition {
+            std::unique_ptr<SegmentedLog> log;
+            std::unique_ptr<CommitLog> disk;    // null unless the topic is durable
+            std::mutex appendMtx;               // keeps disk and memory offsets in step
+        };
+
         std::string topicName;
         std::string topicId;
-        std::vector<std::shared_ptr<Message>> messages;
-        mutable std::mutex mtx;
+        std::vector<std::unique_ptr<Partition>> partitions;
+
+        // Interval fsync: one thread per durable topic syncs dirty partitions
+        std::thread flusher;
+        std::mutex flusherMtx;
+        std::condition_variable flusherCv;
+        bool stopping = false;
+
+        void runFlusher(std::chrono::milliseconds interval);
 
     public:
-        Topic(const std::string& name, const std::string& id)
-            : topicName(name), topicId(id) {}
+        Topic(const std::string& name, const std::string& id, size_t partitionCount = 1,
+              size_t segmentBytes = SegmentedLog::DefaultSegmentBytes);
+        // Durable topic; recovers whatever an earlier run left in the directory
+        Topic(const std::string& name, const std::string& id, size_t partitionCount,
+              const CommitLogOptions& persistence);
+        ~Topic();
+
+        Topic(const Topic&) = delete;
+        Topic& operator=(const Topic&) = delete;
 
         std::string getTopicName() const { return topicName; }
         std::string getTopicId() const { return topicId; }
+        size_t getPartitionCount() const { return partitions.size(); }
+        bool isDurable() const { return partitions[0]->disk != nullptr; }
 
-        void addMessage(std::shared_ptr<Message> message) {
-            std::lock_guard<std::mutex> lock(mtx);
-            messages.push_back(message);
+        // Returns the offset of the message within its partition
+        uint64_t addMessage(size_t partition, std::string_view content) {
+            return addMessages(partition, &content, 1);
         }
 
-        std::vector<std::shared_ptr<Message>> getMessages() const {
-            std::lock_guard<std::mutex> lock(mtx);
-            return messages;
+        // count contents in one append; returns the offset of the first.
+        // Durable topics write them to disk before they become visible. When
+        // fsyncEveryMessages are unsynced the call returns only once a sync
+        // covers them; it waits after releasing the append lock, so publishers
+        // that arrive meanwhile share the next fsync. Throws if an fsync fails.
+        uint64_t addMessages(size_t partition, const std::string_view* contents, size_t count);
+
+        size_t getMessageCount(size_t partition) const {
+            return static_cast<size_t>(partitions[partition]->log->size());
         }
 
+        // Total across partitions
         size_t getMessageCount() const {
-            std::lock_guard<std::mutex> lock(mtx);
-            return messages.size();
+            size_t total = 0;
+            for (const auto& p : partitions) total += static_cast<size_t>(p->log->size());
+            return total;
         }
 
-        std::shared_ptr<Message> getMessageAt(size_t index) const {
-            std::lock_guard<std::mutex> lock(mtx);
-            if (index < messages.size()) {
-                return messages[index];
-            }
-            return nullptr;
+        // index must be in memory: getLog(partition).getBaseOffset() <= index <
+        // getMessageCount(partition). getMessages() covers older offsets too.
+        MessageView getMessageAt(size_t partition, size_t index) const {
+            return MessageView(partition, index, partitions[partition]->log->read(index));
         }
+
+        // Oldest offset still stored: 0, or for a durable topic the base of its
+        // first segment file (older segments may have been deleted)
+        uint64_t getStartOffset(size_t partition) const {
+            const CommitLog* disk = partitions[partition]->disk.get();
+            return disk ? disk->getStartOffset() : 0;
+        }
+
+        // Up to maxCount messages starting at fromOffset; empty if none are there yet
+        // or fromOffset is below getStartOffset(), which consumers must skip to.
+        // A read from disk stops where the in-memory log begins (or at a record that
+        // fails its CRC), so consumers must advance by the size of the batch.
+        MessageBatch getMessages(size_t partition, size_t fromOffset, size_t maxCount) const;
+
+        const SegmentedLog& getLog(size_t partition) const { return *partitions[partition]->log; }
+        const CommitLog* getCommitLog(size_t partition) const { return partitions[partition]->disk.get(); }
     };
 
 } // namespace KafkaSystem
-
@@ -3,27 +3,40 @@
 #include "ISubscriber.h"
 #include <atomic>
 #include <memory>
+#include <vector>
 
 namespace KafkaSystem {
 
-    // TopicSubscriber - associates a subscriber with a topic and tracks offset
+    // TopicSubscriber - associates a subscriber with a topic and tracks one offset per partition
     class TopicSubscriber {
     private:
         std::shared_ptr<Topic> topic;
         std::shared_ptr<ISubscriber> subscriber;
-        std::atomic<int> offset;
+        std::vector<std::atomic<int>> offsets;
 
     public:
         TopicSubscriber(std::shared_ptr<Topic> t, std::shared_ptr<ISubscriber> s)
-            : topic(t), subscriber(s), offset(0) {}
+            : topic(t), subscriber(s), offsets(t->getPartitionCount()) {
+            for (auto& offset : offsets) offset.store(0);
+        }
 
         std::shared_ptr<Topic> getTopic() const { return topic; }
         std::shared_ptr<ISubscriber> getSubscriber() const { return subscriber; }
 
-        int getOffset() const { return offset.load(); }
-        int getAndIncrementOffset() { return offset.fetch_add(1); }
-        void setOffset(int newOffset) { offset.store(newOffset); }
+        int getOffset(size_t partition) const { return offsets[partition].load(); }
+        int getAndIncrementOffset(size_t partition) { return offsets[partition].fetch_add(1); }
+        void setOffset(size_t partition, int newOffset) { offsets[partition].store(newOffset); }
+
+        // Moves the offset from expected past count messages; returns false, and
+        // moves nothing, if it is no longer expected (a concurrent setOffset).
+        bool advanceOffset(size_t partition, int expected, size_t count) {
+            return offsets[partition].compare_exchange_strong(expected, expected + static_cast<int>(count));
+        }
+
+        // Every partition back to the same offset
+        void setOffset(int newOffset) {
+            for (auto& offset : offsets) offset.store(newOffset);
+        }
     };
 
 } // namespace KafkaSystem
-
@@ -4,32 +4,27 @@
 namespace KafkaSystem {
 
     void TopicSubscriberController::run() {
-        running = true;
-        auto topic = topicSubscriber->getTopic();
         auto subscriber = topicSubscriber->getSubscriber();
 
         while (running) {
-            std::shared_ptr<Message> messageToProcess = nullptr;
+            MessageBatch batch;
 
             {
                 std::unique_lock<std::mutex> lock(mtx);
 
                 // Wait until there is a new message (offset < message count)
-                cv.wait(lock, [this, &topic]() {
-                    return !running || topicSubscriber->getOffset() < (int)topic->getMessageCount();
-                });
+                cv.wait(lock, [this]() { return !running || hasMessages(); });
 
                 if (!running) break;
 
-                // Retrieve the next message and increment offset
-                int currentOffset = topicSubscriber->getAndIncrementOffset();
-                messageToProcess = topic->getMessageAt(currentOffset);
+                // Claim everything available, up to a batch
+                batch = claimBatch(RunBatchSize);
             }
 
-            // Process message outside of lock for better concurrency
-            if (messageToProcess) {
+            // Process messages outside of lock; the views point into the topic log
+            for (MessageView message : batch) {
                 try {
-                    subscriber->onMessage(messageToProcess);
+                    subscriber->onMessage(message);
                 }
                 catch (const std::exception& e) {
                     std::cerr << "Error processing message: " << e.what() << std::endl;
@@ -38,12 +33,49 @@ namespace KafkaSystem {
         }
     }
 
+    MessageBatch TopicSubscriberController::poll(size_t maxMessages, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!cv.wait_for(lock, timeout, [this]() { return !running || hasMessages(); }) || !running) {
+            return MessageBatch();
+        }
+        return claimBatch(maxMessages);
+    }
+
+    bool TopicSubscriberController::hasMessages() const {
+        return topicSubscriber->getOffset(partition) < (int)topic->getMessageCount(partition);
+    }
+
+    // Called with mtx held
+    // Advances by the batch actually read, which can be shorter than maxMessages
+    // even with more available (a disk read stops where the in-memory log begins)
+    MessageBatch TopicSubscriberController::claimBatch(size_t maxMessages) {
+        while (true) {
+            int first = topicSubscriber->getOffset(partition);
+            int start = static_cast<int>(topic->getStartOffset(partition));
+            if (first < start) {
+                // Older records are gone from disk: resume at the oldest one kept
+                topicSubscriber->advanceOffset(partition, first, static_cast<size_t>(start - first));
+                continue;
+            }
+            MessageBatch batch = topic->getMessages(partition, first, maxMessages);
+            if (batch.empty() || topicSubscriber->advanceOffset(partition, first, batch.size())) {
+                return batch;
+            }
+        }
+    }
+
     void TopicSubscriberController::stop() {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            running = false;
+        }
         cv.notify_all();
     }
 
     void TopicSubscriberController::notifyNewMessage() {
+        // The consumer checks the message count under mtx before it waits; taking
+        // mtx here means the notify cannot fall between that check and the wait.
+        { std::lock_guard<std::mutex> lock(mtx); }
         cv.notify_one();
     }
 
@@ -5,23 +5,42 @@
 #include <condition_variable>
 #include <atomic>
 #include <memory>
+#include <chrono>
 
 namespace KafkaSystem {
 
     // TopicSubscriberController - manages message consumption for a subscriber
-    // Implements the PULL model where subscriber pulls messages
+    // Implements the PULL model where subscriber pulls messages.
+    // One controller (and thread) per partition of the subscription.
+    // run() drives a pushing subscriber; poll() lets a caller pull batches itself.
     class TopicSubscriberController {
     private:
+        // Messages run() claims per wakeup; offsets move once per batch
+        static constexpr size_t RunBatchSize = 64;
+
         std::shared_ptr<TopicSubscriber> topicSubscriber;
+        std::shared_ptr<Topic> topic;
+        size_t partition;
         std::mutex mtx;
         std::condition_variable cv;
         std::atomic<bool> running;
 
+        bool hasMessages() const;
+        MessageBatch claimBatch(size_t maxMessages);
+
     public:
-        explicit TopicSubscriberController(std::shared_ptr<TopicSubscriber> ts)
-            : topicSubscriber(ts), running(false) {}
+        TopicSubscriberController(std::shared_ptr<TopicSubscriber> ts, size_t partitionIndex = 0)
+            : topicSubscriber(ts), topic(ts->getTopic()), partition(partitionIndex), running(true) {}
+
+        size_t getPartition() const { return partition; }
 
         void run();
+
+        // Waits up to timeout for at least one message, then claims up to
+        // maxMessages consecutive ones with a single lock and offset update.
+        // Empty on timeout or after stop().
+        MessageBatch poll(size_t maxMessages, std::chrono::milliseconds timeout);
+
         void stop();
         void notifyNewMessage();
 
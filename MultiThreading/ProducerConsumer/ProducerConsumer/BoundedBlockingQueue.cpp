@@ -1,53 +1,66 @@
 #include <iostream>
 #include <thread>
-#include <deque>
-#include <semaphore>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include "BoundedBlockingQueue.h"
 
 using namespace std;
 
-class BoundedBlockingQueue {
-private:
-    counting_semaphore<> full;    // number of filled slots
-    counting_semaphore<> empty;   // number of empty slots
-    binary_semaphore mutex;       // mutual exclusion for deque
+// Move-only payload: the queue never copies it
+struct Buffer {
+    int producer;
+    int sequence;
+    vector<char> bytes;
+};
 
-    deque<int> dq;                // NOT thread-safe by itself
+// Producer thread: hands over ownership of each buffer
+void producer(BoundedBlockingQueue<unique_ptr<Buffer>>& queue, int id) {
+    for (int i = 1; i <= 10; i++) {
+        auto buffer = make_unique<Buffer>(Buffer{ id, i, vector<char>(256, 'x') });
 
-public:
-    BoundedBlockingQueue(int capacity)
-        : full(0), empty(capacity), mutex(1) {
+        // Give up on an item if the consumer falls more than 50ms behind
+        if (!queue.try_enqueue_for(std::move(buffer), chrono::milliseconds(50))) {
+            cout << "Producer " << id << " timed out on item " << i << endl;
+            continue;       // buffer was not moved from and is still ours
+        }
+        this_thread::sleep_for(chrono::milliseconds(10));
     }
+}
 
-    // enqueue (Producer)
-    void enqueue(int element) {
-        empty.acquire();          // wait for empty slot
-        mutex.acquire();          // enter critical section
-
-        dq.push_front(element);   // add item
+// Consumer thread: takes whatever is queued in batches of up to 4
+void consumer(BoundedBlockingQueue<unique_ptr<Buffer>>& queue) {
+    vector<unique_ptr<Buffer>> batch;
+    size_t total = 0;
 
-        mutex.release();          // exit critical section
-        full.release();           // signal item available
+    // drain_to returns 0 only after close() and once everything was taken
+    while (queue.drain_to(batch, 4) > 0) {
+        for (auto& buffer : batch)
+            cout << "Consumed: producer " << buffer->producer << " item " << buffer->sequence << endl;
+        total += batch.size();
+        batch.clear();
     }
+    cout << "Consumer saw " << total << " buffers" << endl;
+}
 
-    // dequeue (Consumer)
-    int dequeue() {
-        full.acquire();           // wait for available item
-        mutex.acquire();          // enter critical section
+int main() {
+    BoundedBlockingQueue<unique_ptr<Buffer>> queue(5);
 
-        int result = dq.back();
-        dq.pop_back();            // remove item
+    thread c(consumer, ref(queue));
+    thread p1(producer, ref(queue), 1);
+    thread p2(producer, ref(queue), 2);
 
-        mutex.release();          // exit critical section
-        empty.release();          // signal empty slot
+    p1.join();
+    p2.join();
 
-        return result;
-    }
+    // No more producers: let the consumer finish what is queued and stop
+    queue.close();
+    c.join();
 
-    // size (non-blocking, but protected)
-    int size() {
-        mutex.acquire();
-        int result = dq.size();
-        mutex.release();
-        return result;
-    }
-};
+    // A wait with a deadline on the now closed, empty queue returns at once
+    auto late = queue.try_dequeue_until(chrono::steady_clock::now() + chrono::seconds(1));
+    cout << "After close: " << (late ? "got an item" : "closed and empty") << endl;
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#ifndef BOUNDED_BLOCKING_QUEUE_H
+#define BOUNDED_BLOCKING_QUEUE_H
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <optional>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+/*
+    Bounded blocking queue for any movable element type, including
+    move-only payloads such as std::unique_ptr<Buffer>.
+    One mutex and two condition variables (producers wait on not_full,
+    consumers on not_empty) around a fixed ring, so steady-state
+    operation never allocates.
+
+    close() ends the stream: producers are refused from then on, while
+    consumers keep receiving what is already queued and only see "closed"
+    (false / std::nullopt / 0) once it is empty. That lets a pipeline shut
+    down without losing items and without sentinel values.
+
+    Calls that can fail take the item by rvalue reference and only move
+    from it on success, so a timed-out or refused item stays with the caller.
+*/
+template<typename T>
+class BoundedBlockingQueue {
+public:
+    explicit BoundedBlockingQueue(size_t capacity)
+        : ring(capacity > 0 ? capacity : 1)
+    {
+    }
+
+    BoundedBlockingQueue(const BoundedBlockingQueue&) = delete;
+    BoundedBlockingQueue& operator=(const BoundedBlockingQueue&) = delete;
+
+    // enqueue (Producer): waits for space; false if the queue is closed
+    bool enqueue(T&& item)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        ++waitingProducers;
+        not_full.wait(lock, [this] { return count < ring.size() || isClosed; });
+        --waitingProducers;
+        return push(lock, item);
+    }
+
+    bool enqueue(const T& item)
+    {
+        T copy(item);
+        return enqueue(std::move(copy));
+    }
+
+    template<typename Rep, typename Period>
+    bool try_enqueue_for(T&& item, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return try_enqueue_until(std::move(item), std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename Clock, typename Duration>
+    bool try_enqueue_until(T&& item, const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        ++waitingProducers;
+        bool ready = not_full.wait_until(lock, deadline, [this] { return count < ring.size() || isClosed; });
+        --waitingProducers;
+        if (!ready)
+            return false;
+        return push(lock, item);
+    }
+
+    // dequeue (Consumer): waits for an item; nullopt once closed and drained
+    std::optional<T> dequeue()
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [this] { return count > 0 || isClosed; });
+        return pop(lock);
+    }
+
+    template<typename Rep, typename Period>
+    std::optional<T> try_dequeue_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return try_dequeue_until(std::chrono::steady_clock::now() + timeout);
+    }
+
+    template<typename Clock, typename Duration>
+    std::optional<T> try_dequeue_until(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!not_empty.wait_until(lock, deadline, [this] { return count > 0 || isClosed; }))
+            return std::nullopt;
+        return pop(lock);
+    }
+
+    /*
+        Batch consumption: waits for at least one item, then moves up to max
+        of them into out under the same lock. Returns how many were appended,
+        0 only once the queue is closed and empty (max == 0 counts as 1, so
+        an open queue never reports 0).
+    */
+    size_t drain_to(std::vector<T>& out, size_t max)
+    {
+        if (max == 0)
+            max = 1;
+
+        std::unique_lock<std::mutex> lock(mtx);
+        not_empty.wait(lock, [this] { return count > 0 || isClosed; });
+
+        size_t n = count < max ? count : max;
+        for (size_t i = 0; i < n; ++i) {
+            out.push_back(std::move(*ring[head]));
+            ring[head].reset();
+            head = (head + 1) % ring.size();
+        }
+        count -= n;
+        // n slots opened up: wake that many producers, if that many are waiting
+        size_t wake = n < waitingProducers ? n : waitingProducers;
+        lock.unlock();
+
+        for (size_t i = 0; i < wake; ++i)
+            not_full.notify_one();
+        return n;
+    }
+
+    // Refuse new items and wake every waiter; queued items can still be taken
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            isClosed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+    bool closed() const
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return isClosed;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+
+    size_t capacity() const { return ring.size(); }
+
+private:
+    // Both helpers run after the wait, with the lock held
+    bool push(std::unique_lock<std::mutex>& lock, T& item)
+    {
+        if (isClosed)
+            return false;
+
+        ring[(head + count) % ring.size()].emplace(std::move(item));
+        ++count;
+        lock.unlock();
+
+        not_empty.notify_one();      // buffer is not empty now -> wake one consumer
+        return true;
+    }
+
+    std::optional<T> pop(std::unique_lock<std::mutex>& lock)
+    {
+        if (count == 0)
+            return std::nullopt;     // closed and drained
+
+        std::optional<T> item(std::move(*ring[head]));
+        ring[head].reset();
+        head = (head + 1) % ring.size();
+        --count;
+        lock.unlock();
+
+        not_full.notify_one();       // buffer has space now -> wake one producer
+        return item;
+    }
+
+    std::vector<std::optional<T>> ring;
+    size_t head = 0;
+    size_t count = 0;
+    size_t waitingProducers = 0;     // blocked in enqueue / try_enqueue_until
+    bool isClosed = false;
+
+    mutable std::mutex mtx;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+};
+
+#endif
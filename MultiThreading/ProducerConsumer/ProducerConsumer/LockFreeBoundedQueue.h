@@ -0,0 +1,200 @@
+#ifndef LOCK_FREE_BOUNDED_QUEUE_H
+#define LOCK_FREE_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/*
+    Bounded multi-producer / multi-consumer queue without locks.
+    Drop-in for BoundedBlockingQueue: enqueue/dequeue block, size() is a snapshot.
+
+    - capacity is rounded up to a power of two, so a ticket maps to its
+      slot with a mask instead of a division
+    - every slot carries a sequence ("turn") number: for ticket t in round
+      r = t / capacity the slot is free when turn == 2r and full when
+      turn == 2r + 1, so producers and consumers meet only on the slot
+      they own and never on a shared lock
+    - head (next enqueue ticket) and tail (next dequeue ticket) live on
+      their own cache lines, and so does every slot, so producers and
+      consumers do not invalidate each other's lines
+    - blocking calls take a ticket, spin briefly on their slot, then sleep
+      on it with atomic::wait (a futex on Linux, WaitOnAddress on Windows).
+      A wakeup is only issued when somebody is asleep on that very slot.
+*/
+template<typename T>
+class LockFreeBoundedQueue {
+public:
+    explicit LockFreeBoundedQueue(size_t capacity)
+    {
+        size_t rounded = 1;
+        while (rounded < capacity)
+            rounded <<= 1;
+        mask = rounded - 1;
+        shift = 0;
+        while ((size_t(1) << shift) < rounded)
+            ++shift;
+        slots.reset(new Slot[rounded]);
+    }
+
+    ~LockFreeBoundedQueue()
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (slots[i].turn.load(std::memory_order_relaxed) & 1)
+                slots[i].value()->~T();
+        }
+    }
+
+    LockFreeBoundedQueue(const LockFreeBoundedQueue&) = delete;
+    LockFreeBoundedQueue& operator=(const LockFreeBoundedQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // enqueue (Producer): waits for a free slot
+    template<typename... Args>
+    void enqueue(Args&&... args)
+    {
+        size_t ticket = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[ticket & mask];
+        waitForTurn(slot, 2 * round(ticket));
+        publish(slot, 2 * round(ticket) + 1, std::forward<Args>(args)...);
+    }
+
+    // dequeue (Consumer): waits for an item
+    T dequeue()
+    {
+        size_t ticket = tail.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[ticket & mask];
+        waitForTurn(slot, 2 * round(ticket) + 1);
+        return consume(slot, 2 * round(ticket) + 2);
+    }
+
+    // Non-blocking: only claim a ticket once its slot is ready
+    template<typename... Args>
+    bool try_enqueue(Args&&... args)
+    {
+        size_t ticket = head.load(std::memory_order_acquire);
+        while (true) {
+            Slot& slot = slots[ticket & mask];
+            if (slot.turn.load(std::memory_order_acquire) == 2 * round(ticket)) {
+                if (head.compare_exchange_strong(ticket, ticket + 1)) {
+                    publish(slot, 2 * round(ticket) + 1, std::forward<Args>(args)...);
+                    return true;
+                }
+            } else {
+                // Full, unless another producer moved head in the meantime
+                size_t seen = ticket;
+                ticket = head.load(std::memory_order_acquire);
+                if (ticket == seen)
+                    return false;
+            }
+        }
+    }
+
+    bool try_dequeue(T& out)
+    {
+        size_t ticket = tail.load(std::memory_order_acquire);
+        while (true) {
+            Slot& slot = slots[ticket & mask];
+            if (slot.turn.load(std::memory_order_acquire) == 2 * round(ticket) + 1) {
+                if (tail.compare_exchange_strong(ticket, ticket + 1)) {
+                    out = consume(slot, 2 * round(ticket) + 2);
+                    return true;
+                }
+            } else {
+                size_t seen = ticket;
+                ticket = tail.load(std::memory_order_acquire);
+                if (ticket == seen)
+                    return false;
+            }
+        }
+    }
+
+    // Approximate while other threads are running; negative while consumers wait
+    long long size() const
+    {
+        return static_cast<long long>(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed));
+    }
+
+    bool empty() const { return size() <= 0; }
+
+private:
+    static constexpr size_t CacheLine = 64;
+    static constexpr int SpinLimit = 128;
+
+    struct alignas(CacheLine) Slot {
+        std::atomic<size_t> turn{0};
+        std::atomic<int> sleepers{0};   // threads inside turn.wait()
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    size_t round(size_t ticket) const { return ticket >> shift; }
+
+    template<typename... Args>
+    void publish(Slot& slot, size_t nextTurn, Args&&... args)
+    {
+        new (slot.storage) T(std::forward<Args>(args)...);
+        advance(slot, nextTurn);
+    }
+
+    T consume(Slot& slot, size_t nextTurn)
+    {
+        T result = std::move(*slot.value());
+        slot.value()->~T();
+        advance(slot, nextTurn);
+        return result;
+    }
+
+    void advance(Slot& slot, size_t nextTurn)
+    {
+        // seq_cst pairs with the sleeper bumping `sleepers` before its last look:
+        // either it sees the new turn or we see it asleep and wake it
+        slot.turn.store(nextTurn, std::memory_order_seq_cst);
+        if (slot.sleepers.load(std::memory_order_seq_cst) > 0)
+            slot.turn.notify_all();
+    }
+
+    void waitForTurn(Slot& slot, size_t expected)
+    {
+        for (int spin = 0; spin < SpinLimit; ++spin) {
+            if (slot.turn.load(std::memory_order_acquire) == expected)
+                return;
+            cpuRelax();
+        }
+
+        while (true) {
+            slot.sleepers.fetch_add(1, std::memory_order_seq_cst);
+            size_t seen = slot.turn.load(std::memory_order_seq_cst);
+            if (seen != expected)
+                slot.turn.wait(seen, std::memory_order_acquire);
+            slot.sleepers.fetch_sub(1, std::memory_order_relaxed);
+            if (seen == expected || slot.turn.load(std::memory_order_acquire) == expected)
+                return;
+        }
+    }
+
+    static void cpuRelax()
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    // Read-only after construction, kept off the lines that are written
+    size_t mask;
+    size_t shift;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(CacheLine) std::atomic<size_t> head{0};    // next ticket for enqueue
+    alignas(CacheLine) std::atomic<size_t> tail{0};    // next ticket for dequeue
+};
+
+#endif
@@ -0,0 +1,337 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <semaphore>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <optional>
+#include "BoundedBlockingQueue.h"
+#include "LockFreeBoundedQueue.h"
+#include "SpscQueue.h"
+
+using namespace std;
+
+/*
+    Throughput of every bounded queue in this folder under P producers and
+    C consumers. The first three are the original int-only classes (the
+    semaphore + deque queue BoundedBlockingQueue.cpp started out as,
+    UsingOneConditionVariable.cpp and UsingTwoConditionVariables.cpp) with
+    the per-item printing removed. Later sections cover drain_to batching
+    of the templated BoundedBlockingQueue and the single producer / single
+    consumer case.
+
+    g++ -std=c++20 -O2 -pthread QueueBenchmark.cpp
+*/
+
+class SemaphoreQueue {
+private:
+    counting_semaphore<> full;
+    counting_semaphore<> empty;
+    binary_semaphore mutex;
+    deque<int> dq;
+
+public:
+    SemaphoreQueue(int capacity) : full(0), empty(capacity), mutex(1) {}
+
+    void enqueue(int element) {
+        empty.acquire();
+        mutex.acquire();
+        dq.push_front(element);
+        mutex.release();
+        full.release();
+    }
+
+    int dequeue() {
+        full.acquire();
+        mutex.acquire();
+        int result = dq.back();
+        dq.pop_back();
+        mutex.release();
+        empty.release();
+        return result;
+    }
+};
+
+class OneCvQueue {
+private:
+    vector<int> buffer;
+    int size;
+    int cnt = 0;
+    int buffin = 0;
+    int buffout = 0;
+    mutex mtx;
+    condition_variable cv;
+
+public:
+    OneCvQueue(int n) : buffer(n), size(n) {}
+
+    void enqueue(int item) {
+        unique_lock<mutex> lock(mtx);
+        while (cnt == size)
+            cv.wait(lock);
+        buffer[buffin] = item;
+        buffin = (buffin + 1) % size;
+        cnt++;
+        cv.notify_all();
+    }
+
+    int dequeue() {
+        unique_lock<mutex> lock(mtx);
+        while (cnt == 0)
+            cv.wait(lock);
+        int item = buffer[buffout];
+        buffout = (buffout + 1) % size;
+        cnt--;
+        cv.notify_all();
+        return item;
+    }
+};
+
+class TwoCvQueue {
+private:
+    vector<int> buffer;
+    int size;
+    int cnt = 0;
+    int buffin = 0;
+    int buffout = 0;
+    mutex mtx;
+    condition_variable not_full;
+    condition_variable not_empty;
+
+public:
+    TwoCvQueue(int n) : buffer(n), size(n) {}
+
+    void enqueue(int item) {
+        unique_lock<mutex> lock(mtx);
+        while (cnt == size)
+            not_full.wait(lock);
+        buffer[buffin] = item;
+        buffin = (buffin + 1) % size;
+        cnt++;
+        not_empty.notify_one();
+    }
+
+    int dequeue() {
+        unique_lock<mutex> lock(mtx);
+        while (cnt == 0)
+            not_empty.wait(lock);
+        int item = buffer[buffout];
+        buffout = (buffout + 1) % size;
+        cnt--;
+        not_full.notify_one();
+        return item;
+    }
+};
+
+// Million items per second moved from producers to consumers
+template<typename Queue>
+double itemsPerSec(int producers, int consumers, int items, int capacity)
+{
+    Queue queue(capacity);
+    atomic<long long> checksum{0};
+    vector<thread> threads;
+
+    auto start = chrono::steady_clock::now();
+
+    for (int p = 0; p < producers; ++p) {
+        int count = items / producers + (p < items % producers ? 1 : 0);
+        threads.emplace_back([&queue, count] {
+            for (int i = 1; i <= count; ++i)
+                queue.enqueue(i);
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        int count = items / consumers + (c < items % consumers ? 1 : 0);
+        threads.emplace_back([&queue, &checksum, count] {
+            long long local = 0;
+            for (int i = 0; i < count; ++i)
+                local += queue.dequeue();
+            checksum += local;
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    // Every producer sends 1..count, so the sum tells us nothing was lost or duplicated
+    long long expected = 0;
+    for (int p = 0; p < producers; ++p) {
+        long long count = items / producers + (p < items % producers ? 1 : 0);
+        expected += count * (count + 1) / 2;
+    }
+    if (checksum != expected)
+        cout << "checksum mismatch: " << checksum << " != " << expected << endl;
+
+    return items / elapsed.count() / 1e6;
+}
+
+struct DrainResult {
+    double itemsPerSec;
+    size_t consumerLocks;    // dequeue/drain_to calls made by the consumers
+};
+
+// Templated BoundedBlockingQueue: consumers take up to `batch` items per lock until close()
+DrainResult drainItemsPerSec(int producers, int consumers, int items, int capacity, size_t batch)
+{
+    BoundedBlockingQueue<int> queue(capacity);
+    atomic<long long> checksum{0};
+    atomic<size_t> locks{0};
+    vector<thread> producerThreads, consumerThreads;
+
+    auto start = chrono::steady_clock::now();
+
+    for (int p = 0; p < producers; ++p) {
+        int count = items / producers + (p < items % producers ? 1 : 0);
+        producerThreads.emplace_back([&queue, count] {
+            for (int i = 1; i <= count; ++i)
+                queue.enqueue(int(i));
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        consumerThreads.emplace_back([&queue, &checksum, &locks, batch] {
+            long long local = 0;
+            size_t calls = 0;
+            vector<int> chunk;
+            chunk.reserve(batch);
+            while (true) {
+                ++calls;
+                if (batch == 1) {
+                    optional<int> item = queue.dequeue();
+                    if (!item)
+                        break;
+                    local += *item;
+                } else {
+                    chunk.clear();
+                    if (queue.drain_to(chunk, batch) == 0)
+                        break;
+                    for (int item : chunk)
+                        local += item;
+                }
+            }
+            checksum += local;
+            locks += calls;
+        });
+    }
+
+    for (auto& t : producerThreads)
+        t.join();
+    queue.close();
+    for (auto& t : consumerThreads)
+        t.join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    long long expected = 0;
+    for (int p = 0; p < producers; ++p) {
+        long long count = items / producers + (p < items % producers ? 1 : 0);
+        expected += count * (count + 1) / 2;
+    }
+    if (checksum != expected)
+        cout << "checksum mismatch: " << checksum << " != " << expected << endl;
+
+    return DrainResult{ items / elapsed.count() / 1e6, locks.load() };
+}
+
+// One producer, one consumer, moving `batch` items per call
+double spscBulkItemsPerSec(int items, int capacity, size_t batch)
+{
+    SpscQueue<int> queue(capacity);
+    long long checksum = 0;
+
+    auto start = chrono::steady_clock::now();
+
+    thread producer([&queue, items, batch] {
+        vector<int> chunk(batch);
+        int next = 1;
+        while (next <= items) {
+            size_t count = min<size_t>(batch, items - next + 1);
+            for (size_t i = 0; i < count; ++i)
+                chunk[i] = next + static_cast<int>(i);
+
+            size_t sent = 0;
+            while (sent < count) {
+                size_t n = queue.enqueue_bulk(chunk.begin() + sent, count - sent);
+                if (n == 0)
+                    this_thread::yield();
+                sent += n;
+            }
+            next += static_cast<int>(count);
+        }
+    });
+
+    thread consumer([&queue, &checksum, items, batch] {
+        vector<int> chunk(batch);
+        int received = 0;
+        while (received < items) {
+            size_t n = queue.dequeue_bulk(chunk.begin(), batch);
+            if (n == 0)
+                this_thread::yield();
+            for (size_t i = 0; i < n; ++i)
+                checksum += chunk[i];
+            received += static_cast<int>(n);
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (checksum != static_cast<long long>(items) * (items + 1) / 2)
+        cout << "checksum mismatch: " << checksum << endl;
+
+    return items / elapsed.count() / 1e6;
+}
+
+int main() {
+    const int items = 2000000;
+    const int capacity = 1024;
+    const pair<int, int> shapes[] = { {1, 1}, {2, 2}, {4, 4}, {8, 8}, {1, 8}, {8, 1} };
+
+    cout << "hardware_concurrency = " << thread::hardware_concurrency()
+         << ", " << items << " ints, capacity " << capacity << "\n\n";
+    cout << left << setw(8) << "P x C" << right
+         << setw(14) << "semaphore" << setw(14) << "one cv" << setw(14) << "two cv"
+         << setw(14) << "lock-free" << "   (M items/s)\n";
+
+    for (auto [producers, consumers] : shapes) {
+        cout << left << setw(8) << (to_string(producers) + " x " + to_string(consumers)) << right
+             << fixed << setprecision(2)
+             << setw(14) << itemsPerSec<SemaphoreQueue>(producers, consumers, items, capacity)
+             << setw(14) << itemsPerSec<OneCvQueue>(producers, consumers, items, capacity)
+             << setw(14) << itemsPerSec<TwoCvQueue>(producers, consumers, items, capacity)
+             << setw(14) << itemsPerSec<LockFreeBoundedQueue<int>>(producers, consumers, items, capacity)
+             << endl;
+    }
+
+    cout << "\nTemplated BoundedBlockingQueue<int>, consumers using drain_to\n";
+    cout << left << setw(8) << "P x C" << setw(8) << "batch" << right
+         << setw(14) << "M items/s" << setw(16) << "consumer locks" << "\n";
+    for (auto [producers, consumers] : { pair<int, int>{1, 1}, pair<int, int>{4, 4} }) {
+        for (size_t batch : { 1, 16, 64 }) {
+            DrainResult r = drainItemsPerSec(producers, consumers, items, capacity, batch);
+            cout << left << setw(8) << (to_string(producers) + " x " + to_string(consumers))
+                 << setw(8) << batch << right << fixed << setprecision(2)
+                 << setw(14) << r.itemsPerSec << setw(16) << r.consumerLocks << "\n";
+        }
+    }
+
+    cout << "\nOne producer, one consumer (M items/s)\n";
+    cout << left << setw(24) << "two cv" << right << fixed << setprecision(2)
+         << setw(10) << itemsPerSec<TwoCvQueue>(1, 1, items, capacity) << "\n";
+    cout << left << setw(24) << "lock-free mpmc" << right
+         << setw(10) << itemsPerSec<LockFreeBoundedQueue<int>>(1, 1, items, capacity) << "\n";
+    cout << left << setw(24) << "spsc" << right
+         << setw(10) << itemsPerSec<SpscQueue<int>>(1, 1, items, capacity) << "\n";
+    for (size_t batch : { 16, 64, 256 }) {
+        cout << left << setw(24) << ("spsc bulk x" + to_string(batch)) << right
+             << setw(10) << spscBulkItemsPerSec(items, capacity, batch) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <algorithm>
+
+/*
+    Bounded queue for exactly one producer thread and one consumer thread.
+    Every try_ and _bulk call is wait-free: a fixed number of steps, no CAS
+    loops, no locks.
+
+    - head is written only by the producer, tail only by the consumer; each
+      sits on its own cache line next to the thread's cached copy of the
+      other index. The producer re-reads tail (a cache miss) only when its
+      cached copy says the ring is full, the consumer re-reads head only
+      when it thinks the ring is empty.
+    - enqueue_bulk / dequeue_bulk move a whole batch and publish it with a
+      single release store, so the other side pays one cache-line transfer
+      per batch instead of one per item.
+    - enqueue/dequeue are blocking conveniences on top (spin, then yield).
+*/
+template<typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+    {
+        size_t rounded = 1;
+        while (rounded < capacity)
+            rounded <<= 1;
+        mask = rounded - 1;
+        storage.reset(new Storage[rounded]);
+    }
+
+    ~SpscQueue()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_relaxed);
+        for (; t != h; ++t)
+            slot(t)->~T();
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer side
+
+    template<typename... Args>
+    bool try_enqueue(Args&&... args)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail == capacity()) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == capacity())
+                return false;
+        }
+        new (&storage[h & mask]) T(std::forward<Args>(args)...);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Copies (or moves, through std::make_move_iterator) up to count items
+    // starting at first. Returns how many fit.
+    template<typename It>
+    size_t enqueue_bulk(It first, size_t count)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (capacity() - (h - cachedTail) < count)
+            cachedTail = tail.load(std::memory_order_acquire);
+
+        size_t n = std::min(count, capacity() - (h - cachedTail));
+        for (size_t i = 0; i < n; ++i, ++first)
+            new (&storage[(h + i) & mask]) T(*first);
+        if (n > 0)
+            head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    template<typename... Args>
+    void enqueue(Args&&... args)
+    {
+        for (int spin = 0; !try_enqueue(std::forward<Args>(args)...); ++spin)
+            backOff(spin);
+    }
+
+    // Consumer side
+
+    bool try_dequeue(T& out)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                return false;
+        }
+        out = take(t);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves up to max items to out (an output iterator). Returns how many.
+    template<typename OutIt>
+    size_t dequeue_bulk(OutIt out, size_t max)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (cachedHead - t < max)
+            cachedHead = head.load(std::memory_order_acquire);
+
+        size_t n = std::min(max, cachedHead - t);
+        for (size_t i = 0; i < n; ++i, ++out)
+            *out = take(t + i);
+        if (n > 0)
+            tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    T dequeue()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        for (int spin = 0; t == cachedHead; ++spin) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead)
+                backOff(spin);
+        }
+        T result = take(t);
+        tail.store(t + 1, std::memory_order_release);
+        return result;
+    }
+
+    // Either side may call these; the answer can be stale by the time it returns
+    size_t size() const
+    {
+        // tail first: head only grows, so it can never be read behind it
+        size_t t = tail.load(std::memory_order_acquire);
+        return head.load(std::memory_order_acquire) - t;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    static constexpr size_t CacheLine = 64;
+
+    struct Storage {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    T* slot(size_t index) { return std::launder(reinterpret_cast<T*>(storage[index & mask].bytes)); }
+
+    T take(size_t index)
+    {
+        T* item = slot(index);
+        T result = std::move(*item);
+        item->~T();
+        return result;
+    }
+
+    static void backOff(int spin)
+    {
+        // Spinning only helps while the other side is running on another core
+        if (spin > 64)
+            std::this_thread::yield();
+    }
+
+    size_t mask;
+    std::unique_ptr<Storage[]> storage;
+
+    alignas(CacheLine) std::atomic<size_t> head{0};   // next index to write; producer only
+    size_t cachedTail = 0;                            // producer's last look at tail
+
+    alignas(CacheLine) std::atomic<size_t> tail{0};   // next index to read; consumer only
+    size_t cachedHead = 0;                            // consumer's last look at head
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "CpuTopology.h"
+#include <thread>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace {
+#if defined(__linux__)
+    int readTopologyValue(int cpu, const char* file, int fallback)
+    {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + file);
+        int value;
+        return (in >> value) ? value : fallback;
+    }
+#endif
+
+    // Renumber raw (socket, core) ids so sockets are 0..n-1 and cores are unique machine-wide
+    void normalise(std::vector<LogicalCpu>& cpus)
+    {
+        std::map<int, int> socketIds;
+        std::map<std::pair<int, int>, int> coreIds;
+        for (auto& cpu : cpus) {
+            socketIds.emplace(cpu.socket, static_cast<int>(socketIds.size()));
+        }
+        for (auto& cpu : cpus) {
+            int socket = socketIds[cpu.socket];
+            auto key = std::make_pair(socket, cpu.core);
+            coreIds.emplace(key, static_cast<int>(coreIds.size()));
+            cpu.socket = socket;
+            cpu.core = coreIds[key];
+        }
+    }
+}
+
+CpuTopology CpuTopology::detect()
+{
+    CpuTopology topology;
+
+#if defined(_WIN32)
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &length)) {
+        std::map<int, LogicalCpu> byId;
+        int core = 0, socket = 0;
+        for (const auto& entry : info) {
+            if (entry.Relationship != RelationProcessorCore && entry.Relationship != RelationProcessorPackage)
+                continue;
+            for (int bit = 0; bit < static_cast<int>(sizeof(ULONG_PTR) * 8); ++bit) {
+                if (!(entry.ProcessorMask & (ULONG_PTR(1) << bit)))
+                    continue;
+                LogicalCpu& cpu = byId.emplace(bit, LogicalCpu{ bit, bit, 0 }).first->second;
+                if (entry.Relationship == RelationProcessorCore)
+                    cpu.core = core;
+                else
+                    cpu.socket = socket;
+            }
+            if (entry.Relationship == RelationProcessorCore)
+                ++core;
+            else
+                ++socket;
+        }
+        for (auto& idAndCpu : byId)
+            topology.logicalCpus.push_back(idAndCpu.second);
+    }
+#elif defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int id = 0; id < CPU_SETSIZE; ++id) {
+            if (!CPU_ISSET(id, &allowed))
+                continue;
+            topology.logicalCpus.push_back(LogicalCpu{ id,
+                readTopologyValue(id, "core_id", id),
+                readTopologyValue(id, "physical_package_id", 0) });
+        }
+    }
+#endif
+
+    if (topology.logicalCpus.empty()) {
+        int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int id = 0; id < count; ++id)
+            topology.logicalCpus.push_back(LogicalCpu{ id, id, 0 });
+    }
+
+    normalise(topology.logicalCpus);
+    return topology;
+}
+
+size_t CpuTopology::socketCount() const
+{
+    std::set<int> sockets;
+    for (const auto& cpu : logicalCpus)
+        sockets.insert(cpu.socket);
+    return sockets.size();
+}
+
+std::vector<int> CpuTopology::cpusOfSocket(int socket) const
+{
+    std::vector<int> result;
+    for (const auto& cpu : logicalCpus) {
+        if (cpu.socket == socket)
+            result.push_back(cpu.id);
+    }
+    return result;
+}
+
+std::vector<int> CpuTopology::onePerPhysicalCore(int socket) const
+{
+    std::vector<int> result;
+    std::set<int> seenCores;
+    for (const auto& cpu : logicalCpus) {
+        if (socket >= 0 && cpu.socket != socket)
+            continue;
+        if (seenCores.insert(cpu.core).second)
+            result.push_back(cpu.id);
+    }
+    return result;
+}
+
+bool CpuTopology::pinCurrentThread(int cpu)
+{
+#if defined(_WIN32)
+    if (cpu < 0 || cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void CpuTopology::nameCurrentThread(const std::string& name)
+{
+#if defined(_WIN32)
+    std::wstring wide(name.begin(), name.end());
+    SetThreadDescription(GetCurrentThread(), wide.c_str());
+#elif defined(__linux__)
+    // The kernel keeps at most 15 characters
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+#else
+    (void)name;
+#endif
+}
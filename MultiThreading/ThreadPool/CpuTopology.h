@@ -0,0 +1,38 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <vector>
+#include <string>
+
+struct LogicalCpu {
+    int id;       // OS cpu number, what the affinity calls take
+    int core;     // physical core, unique across the whole machine
+    int socket;   // physical package, numbered 0..socketCount()-1
+};
+
+/*
+    Which logical CPUs this process may run on and how they map to physical
+    cores and sockets. Linux reads /sys/devices/system/cpu, Windows asks
+    GetLogicalProcessorInformation. Elsewhere every CPU is reported as its own
+    core on socket 0, and pinning is a no-op.
+*/
+class CpuTopology {
+public:
+    static CpuTopology detect();
+
+    const std::vector<LogicalCpu>& cpus() const { return logicalCpus; }
+    size_t socketCount() const;
+    std::vector<int> cpusOfSocket(int socket) const;
+
+    // First hyperthread of every physical core (of one socket, or of all when socket < 0)
+    std::vector<int> onePerPhysicalCore(int socket = -1) const;
+
+    // Both act on the calling thread; pinning returns false if the OS refused
+    static bool pinCurrentThread(int cpu);
+    static void nameCurrentThread(const std::string& name);
+
+private:
+    std::vector<LogicalCpu> logicalCpus;
+};
+
+#endif
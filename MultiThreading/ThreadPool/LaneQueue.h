@@ -0,0 +1,105 @@
+#ifndef LANE_QUEUE_H
+#define LANE_QUEUE_H
+
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include "Task.h"
+
+enum class TaskPriority {
+    High,
+    Normal,
+    Low
+};
+
+constexpr size_t LaneCount = 3;
+
+enum class DeadlinePolicy {
+    Drop,   // a task picked up after its deadline is destroyed without running
+    Flag    // it still runs, and SimpleThreadPool::currentTaskIsLate() is true meanwhile
+};
+
+// What actually sits in a lane: the task plus the latest time it may start
+struct QueuedTask {
+    Task task;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    DeadlinePolicy onMissed = DeadlinePolicy::Drop;
+};
+
+/*
+    One ring per priority lane, served by weighted round-robin.
+    Every lane gets weights[lane] credits per round and a pop takes from
+    the highest lane that still has work and credit. When every non-empty
+    lane has spent its credit a new round starts, so under full load the
+    lanes share the workers weights[High] : weights[Normal] : weights[Low],
+    and a flood of low-priority work never stalls the high lane for more
+    than weights[Low] tasks in a row. Weights are at least 1, so no lane
+    starves either.
+    Same threading rules as SlotRing: callers hold their own mutex.
+*/
+class LaneQueue {
+public:
+    using Weights = std::array<unsigned, LaneCount>;
+
+    explicit LaneQueue(const Weights& laneWeights = Weights{ 8, 4, 1 })
+        : lanes{ SlotRing<QueuedTask>(16), SlotRing<QueuedTask>(64), SlotRing<QueuedTask>(16) }
+    {
+        for (size_t lane = 0; lane < LaneCount; ++lane)
+            weights[lane] = std::max(laneWeights[lane], 1u);
+        credits = weights;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t size(TaskPriority priority) const { return lanes[static_cast<size_t>(priority)].size(); }
+
+    void push_back(TaskPriority priority, QueuedTask&& entry) {
+        lanes[static_cast<size_t>(priority)].push_back(std::move(entry));
+        ++count;
+    }
+
+    // Both pops pick the lane the same way; within it front is oldest, back newest.
+    // lane, if given, receives the lane the task came from.
+    QueuedTask pop_front(TaskPriority* lane = nullptr) {
+        --count;
+        size_t picked = pickLane();
+        if (lane)
+            *lane = static_cast<TaskPriority>(picked);
+        return lanes[picked].pop_front();
+    }
+
+    QueuedTask pop_back(TaskPriority* lane = nullptr) {
+        --count;
+        size_t picked = pickLane();
+        if (lane)
+            *lane = static_cast<TaskPriority>(picked);
+        return lanes[picked].pop_back();
+    }
+
+    // Oldest task of one lane, outside the weighted rotation; the lane must not be empty
+    QueuedTask pop_lane(TaskPriority priority) {
+        --count;
+        return lanes[static_cast<size_t>(priority)].pop_front();
+    }
+
+private:
+    size_t pickLane() {
+        // Caller made sure something is queued, so the second pass always finds a lane
+        while (true) {
+            for (size_t lane = 0; lane < LaneCount; ++lane) {
+                if (credits[lane] > 0 && !lanes[lane].empty()) {
+                    --credits[lane];
+                    return lane;
+                }
+            }
+            credits = weights;
+        }
+    }
+
+    std::array<SlotRing<QueuedTask>, LaneCount> lanes;
+    Weights weights;
+    Weights credits;
+    size_t count = 0;
+};
+
+#endif
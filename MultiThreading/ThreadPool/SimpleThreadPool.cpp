@@ -1,67 +1,534 @@
 ﻿#include "SimpleThreadPool.h"
+#include "CpuTopology.h"
 
-SimpleThreadPool::SimpleThreadPool(size_t threadCount) : stop(false)
+namespace {
+    // Lets addTask() recognise a submission coming from one of our own workers.
+    thread_local SimpleThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+
+    // Set around a DeadlinePolicy::Flag task that started late
+    thread_local bool runningLateTask = false;
+
+    ThreadPoolOptions basicOptions(size_t threadCount, SchedulingMode mode)
+    {
+        ThreadPoolOptions options;
+        options.threadCount = threadCount;
+        options.mode = mode;
+        return options;
+    }
+}
+
+SimpleThreadPool::SimpleThreadPool(size_t threadCount, SchedulingMode mode)
+    : SimpleThreadPool(basicOptions(threadCount, mode))
 {
-    for (size_t i = 0; i < threadCount; ++i) {
-        /*
-            This tells std::thread:
-                Call workerThread
-                On this object
-                Internally, it becomes:
-                (this->*workerThread)();
-
-            Can we ever write it without this?
-                ✅ YES — but only if the function is static
-                Example:
-                    class SimpleThreadPool {
-                    public:
-                        static void workerThreadStatic(SimpleThreadPool* pool);
-                    };
-                    
-                    workers.emplace_back(&SimpleThreadPool::workerThreadStatic, this);
-        */
-        workers.emplace_back(&SimpleThreadPool::workerThread, this);
+}
+
+SimpleThreadPool::SimpleThreadPool(const ThreadPoolOptions& options)
+    : tasks(options.laneWeights), stop(false), mode(options.mode), pendingTasks(0), queuedHigh(0), sleepingWorkers(0), nextQueue(0),
+      workerCpus(options.cpus), threadName(options.threadName),
+      idleTimeout(options.idleTimeout), maxQueueWait(options.maxQueueWait),
+      backlogPerWorker(std::max<size_t>(options.backlogPerWorker, 1)),
+      liveWorkers(0), peakWorkers(0), acceptingWorkers(true), supervisorStop(false),
+      missedDeadlines(0), droppedTasks(0)
+{
+    if (options.onePerPhysicalCore && workerCpus.empty())
+        workerCpus = CpuTopology::detect().onePerPhysicalCore();
+
+    minThreads = options.threadCount;
+    if (minThreads == 0)
+        minThreads = !workerCpus.empty() ? workerCpus.size() : std::max(1u, std::thread::hardware_concurrency());
+    maxThreads = std::max(minThreads, options.maxThreads);
+
+    // Every slot an elastic pool may ever use exists up front, so the
+    // vectors never reallocate underneath running workers
+    workers.resize(maxThreads);
+    slotInUse.assign(maxThreads, false);
+    if (mode == SchedulingMode::WorkStealing) {
+        for (size_t i = 0; i < maxThreads; ++i)
+            localQueues.emplace_back(std::make_unique<WorkerQueue>(options.laneWeights));
+    }
+
+    for (size_t i = 0; i < minThreads; ++i)
+        spawnWorker(true);
+
+    if (elastic())
+        supervisor = std::thread(&SimpleThreadPool::supervisorThread, this);
+}
+
+bool SimpleThreadPool::spawnWorker(bool waitForSlot)
+{
+    std::unique_lock<std::mutex> lock(resizeMtx, std::defer_lock);
+    if (waitForSlot)
+        lock.lock();
+    else if (!lock.try_lock())
+        return false;       // somebody else is already growing the pool
+
+    if (!acceptingWorkers || liveWorkers.load() >= maxThreads)
+        return false;
+
+    size_t slot = 0;
+    while (slot < slotInUse.size() && slotInUse[slot])
+        ++slot;
+    if (slot == slotInUse.size())
+        return false;       // a retiring worker has not released its slot yet
+
+    // The previous occupant retired and is on its way out
+    if (workers[slot].joinable())
+        workers[slot].join();
+
+    if (mode == SchedulingMode::WorkStealing)
+        localQueues[slot]->active = true;
+
+    slotInUse[slot] = true;
+    size_t live = liveWorkers.fetch_add(1) + 1;
+    if (live > peakWorkers.load())
+        peakWorkers = live;
+    recordSize(live);
+
+    /*
+        This tells std::thread:
+            Call workerThread
+            On this object
+            Internally, it becomes:
+            (this->*workerThread)();
+
+        Can we ever write it without this?
+            ✅ YES — but only if the function is static
+            Example:
+                class SimpleThreadPool {
+                public:
+                    static void workerThreadStatic(SimpleThreadPool* pool);
+                };
+                
+                workers.emplace_back(&SimpleThreadPool::workerThreadStatic, this);
+    */
+    workers[slot] = std::thread(&SimpleThreadPool::workerMain, this, slot);
+    return true;
+}
+
+bool SimpleThreadPool::tryRetire()
+{
+    size_t live = liveWorkers.load();
+    while (live > minThreads) {
+        if (liveWorkers.compare_exchange_weak(live, live - 1))
+            return true;
     }
+    return false;
 }
 
-void SimpleThreadPool::workerThread()
+void SimpleThreadPool::retireWorker(size_t index)
 {
+    std::lock_guard<std::mutex> lock(resizeMtx);
+    slotInUse[index] = false;
+    recordSize(liveWorkers.load());
+}
+
+void SimpleThreadPool::growIfBacklogged(size_t queued)
+{
+    // Depth rule: nobody idle and a deep queue -> add a worker right now
+    if (!elastic() || liveWorkers.load() >= maxThreads || sleepingWorkers.load() > 0)
+        return;
+    if (queued > liveWorkers.load() * backlogPerWorker)
+        spawnWorker(false);
+}
+
+void SimpleThreadPool::supervisorThread()
+{
+    /*
+        Wait-time rule: a shallow queue never trips the depth rule, but if
+        work keeps sitting there with no idle worker for maxQueueWait, the
+        pool is too small anyway. Add one worker and re-arm.
+    */
+    auto tick = std::max(std::chrono::milliseconds(1), maxQueueWait / 2);
+    bool backlogged = false;
+    Clock::time_point since;
+
+    std::unique_lock<std::mutex> lock(supervisorMtx);
+    while (!supervisorStop) {
+        supervisorCv.wait_for(lock, tick);
+        if (supervisorStop)
+            break;
+
+        if (queuedTaskCount() == 0 || sleepingWorkers.load() > 0) {
+            backlogged = false;
+            continue;
+        }
+
+        Clock::time_point now = Clock::now();
+        if (!backlogged) {
+            backlogged = true;
+            since = now;
+        } else if (now - since >= maxQueueWait) {
+            spawnWorker(true);
+            since = now;
+        }
+    }
+}
+
+size_t SimpleThreadPool::queuedTaskCount()
+{
+    if (mode == SchedulingMode::WorkStealing)
+        return pendingTasks.load();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    return tasks.size();
+}
+
+void SimpleThreadPool::recordSize(size_t threads)
+{
+    // Caller holds resizeMtx
+    history.push_back(PoolSizeSample{ Clock::now(), threads });
+    if (history.size() > 4096)
+        history.pop_front();
+}
+
+PoolStats SimpleThreadPool::stats()
+{
+    PoolStats result;
+    result.liveThreads = liveWorkers.load();
+    result.idleThreads = sleepingWorkers.load();
+    result.peakThreads = peakWorkers.load();
+    result.queuedTasks = queuedTaskCount();
+    result.missedDeadlines = missedDeadlines.load();
+    result.droppedTasks = droppedTasks.load();
+    return result;
+}
+
+std::vector<PoolSizeSample> SimpleThreadPool::sizeHistory()
+{
+    std::lock_guard<std::mutex> lock(resizeMtx);
+    return std::vector<PoolSizeSample>(history.begin(), history.end());
+}
+
+bool SimpleThreadPool::idleWait(std::unique_lock<std::mutex>& lock)
+{
+    // Fixed-size pools sleep until woken; elastic ones wake up to consider retiring
+    if (!elastic()) {
+        cv.wait(lock);
+        return false;
+    }
+    return cv.wait_for(lock, idleTimeout) == std::cv_status::timeout;
+}
+
+void SimpleThreadPool::workerMain(size_t index)
+{
+    // Placement happens on the worker itself, before it touches any task memory
+    if (!workerCpus.empty())
+        CpuTopology::pinCurrentThread(workerCpus[index % workerCpus.size()]);
+    if (!threadName.empty())
+        CpuTopology::nameCurrentThread(threadName + "-" + std::to_string(index));
+
+    if (mode == SchedulingMode::WorkStealing)
+        stealingWorkerThread(index);
+    else
+        workerThread(index);
+}
+
+void SimpleThreadPool::workerThread(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
     while (true) {
-        std::function<void()> task;
+        QueuedTask task;
         {
             std::unique_lock<std::mutex> lock(mtx);
+            bool retire = false;
             while (stop==false && tasks.empty()) {
-                cv.wait(lock);
+                ++sleepingWorkers;      // guarded by mtx in this mode
+                bool timedOut = idleWait(lock);
+                --sleepingWorkers;
+
+                if (timedOut && stop == false && tasks.empty() && tryRetire()) {
+                    retire = true;
+                    break;
+                }
+            }
+
+            if (retire) {
+                lock.unlock();
+                retireWorker(index);
+                return;
             }
 
             if (stop && tasks.empty())
                 return;
 
-            task = tasks.front();
-            tasks.pop();
+            task = tasks.pop_front();
+        }
+
+        runQueued(task);
+    }
+}
+
+void SimpleThreadPool::stealingWorkerThread(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        QueuedTask task;
+        if ((queuedHigh.load(std::memory_order_relaxed) > 0 && stealHigh(index, task))
+            || popLocal(index, task) || steal(index, task)) {
+            pendingTasks.fetch_sub(1);
+            runQueued(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mtx);
+        /*
+            sleepingWorkers is bumped BEFORE re-checking pendingTasks, and
+            addTask bumps pendingTasks BEFORE reading sleepingWorkers.
+            With seq_cst atomics at least one side sees the other, so a task
+            can never be pushed while every worker sleeps through it.
+        */
+        sleepingWorkers.fetch_add(1);
+        bool timedOut = false;
+        while (stop == false && pendingTasks.load() == 0 && !timedOut) {
+            timedOut = idleWait(lock);
+        }
+        sleepingWorkers.fetch_sub(1);
+
+        if (stop && pendingTasks.load() == 0)
+            return;
+        lock.unlock();
+
+        if (timedOut && pendingTasks.load() == 0) {
+            // Only retire with an empty deque; once inactive nobody pushes to it
+            WorkerQueue& q = *localQueues[index];
+            bool retire = false;
+            {
+                std::lock_guard<std::mutex> qlock(q.mtx);
+                if (q.tasks.empty() && tryRetire()) {
+                    q.active = false;
+                    retire = true;
+                }
+            }
+            if (retire) {
+                retireWorker(index);
+                return;
+            }
+            continue;
+        }
+
+        // pendingTasks > 0 but the task may be mid-pop elsewhere: just rescan
+        std::this_thread::yield();
+    }
+}
+
+SimpleThreadPool::WorkerQueue& SimpleThreadPool::lockSubmitQueue(std::unique_lock<std::mutex>& lock)
+{
+    size_t self;
+    if (isOwnWorker(self)) {
+        lock = std::unique_lock<std::mutex>(localQueues[self]->mtx);
+        return *localQueues[self];
+    }
+
+    // Round-robin over deques whose worker is still running
+    while (true) {
+        WorkerQueue& q = *localQueues[nextQueue.fetch_add(1, std::memory_order_relaxed) % localQueues.size()];
+        if (!q.active.load(std::memory_order_relaxed))
+            continue;
+        lock = std::unique_lock<std::mutex>(q.mtx);
+        if (q.active)
+            return q;
+        lock.unlock();
+    }
+}
+
+bool SimpleThreadPool::popLocal(size_t index, QueuedTask& task)
+{
+    WorkerQueue& q = *localQueues[index];
+    std::lock_guard<std::mutex> lock(q.mtx);
+    if (q.tasks.empty())
+        return false;
+
+    TaskPriority lane;
+    task = q.tasks.pop_back(&lane);
+    if (lane == TaskPriority::High)
+        queuedHigh.fetch_sub(1);
+    return true;
+}
+
+bool SimpleThreadPool::steal(size_t thief, QueuedTask& task)
+{
+    // i == n wraps round to the thief's own queue, which lets a thread
+    // that is not a worker pass any index and still scan every deque
+    size_t n = localQueues.size();
+    for (size_t i = 1; i <= n; ++i) {
+        WorkerQueue& victim = *localQueues[(thief + i) % n];
+
+        // Never queue up behind a busy victim, just move on to the next one
+        std::unique_lock<std::mutex> lock(victim.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty())
+            continue;
+
+        TaskPriority lane;
+        task = victim.tasks.pop_front(&lane);
+        if (lane == TaskPriority::High)
+            queuedHigh.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+bool SimpleThreadPool::stealHigh(size_t thief, QueuedTask& task)
+{
+    // Lanes are per deque, so High work pushed behind a worker that is busy
+    // with a long Low task would otherwise wait for it. While any High task
+    // is queued, workers look for it in the other deques before their own.
+    size_t n = localQueues.size();
+    for (size_t i = 1; i < n; ++i) {
+        WorkerQueue& victim = *localQueues[(thief + i) % n];
+
+        std::unique_lock<std::mutex> lock(victim.mtx, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.size(TaskPriority::High) == 0)
+            continue;
+
+        task = victim.tasks.pop_lane(TaskPriority::High);
+        queuedHigh.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void SimpleThreadPool::runQueued(QueuedTask& entry)
+{
+    // Only tasks that carry a deadline pay for reading the clock
+    if (entry.deadline != Clock::time_point::max() && Clock::now() > entry.deadline) {
+        missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+        if (entry.onMissed == DeadlinePolicy::Drop) {
+            droppedTasks.fetch_add(1, std::memory_order_relaxed);
+            entry.task.reset();
+            return;
         }
 
-        task();
+        runningLateTask = true;
+        entry.task();
+        runningLateTask = false;
+        return;
     }
+
+    entry.task();
 }
 
-void SimpleThreadPool::addTask(std::function<void()> task)
+bool SimpleThreadPool::currentTaskIsLate()
 {
+    return runningLateTask;
+}
+
+void SimpleThreadPool::addTask(Task task, const TaskOptions& options)
+{
+    QueuedTask entry{ std::move(task), options.deadline, options.onMissed };
+
+    if (mode == SchedulingMode::WorkStealing) {
+        // Counted before the push: once pushed, a thief may pop the task and
+        // decrement before we get here, and the count must never go below zero
+        bool high = options.priority == TaskPriority::High;
+        size_t queued = pendingTasks.fetch_add(1) + 1;
+        if (high)
+            queuedHigh.fetch_add(1);
+        try {
+            std::unique_lock<std::mutex> lock;
+            lockSubmitQueue(lock).tasks.push_back(options.priority, std::move(entry));
+        }
+        catch (...) {
+            pendingTasks.fetch_sub(1);
+            if (high)
+                queuedHigh.fetch_sub(1);
+            throw;
+        }
+        wakeWorkers(1);
+        growIfBacklogged(queued);
+        return;
+    }
+
+    size_t sleeping, queued;
     {
         std::lock_guard<std::mutex> lock(mtx);
-        tasks.push(task);
+        tasks.push_back(options.priority, std::move(entry));
+        sleeping = sleepingWorkers;
+        queued = tasks.size();
     }
-    cv.notify_one();
+    notifyWorkers(1, sleeping);
+    growIfBacklogged(queued);
+}
+
+void SimpleThreadPool::wakeWorkers(size_t count)
+{
+    // Only touch the shared mutex when somebody is actually asleep
+    size_t sleeping = sleepingWorkers.load();
+    if (sleeping == 0)
+        return;
+
+    { std::lock_guard<std::mutex> lock(mtx); }
+    notifyWorkers(count, sleeping);
+}
+
+void SimpleThreadPool::notifyWorkers(size_t count, size_t sleeping)
+{
+    // Wake exactly as many workers as there is new work for
+    if (sleeping == 0)
+        return;
+
+    if (count >= sleeping) {
+        cv.notify_all();
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            cv.notify_one();
+    }
+}
+
+bool SimpleThreadPool::isOwnWorker(size_t& index) const
+{
+    index = currentWorker;
+    return currentPool == this;
+}
+
+bool SimpleThreadPool::runPendingTask()
+{
+    QueuedTask task;
+    if (mode == SchedulingMode::WorkStealing) {
+        bool found = (currentPool == this)
+            ? popLocal(currentWorker, task) || steal(currentWorker, task)
+            : steal(nextQueue.fetch_add(1, std::memory_order_relaxed) % localQueues.size(), task);
+        if (!found)
+            return false;
+        pendingTasks.fetch_sub(1);
+    } else {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (tasks.empty())
+            return false;
+        task = tasks.pop_front();
+    }
+
+    runQueued(task);
+    return true;
 }
 
 SimpleThreadPool::~SimpleThreadPool()
 {
+    if (supervisor.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(supervisorMtx);
+            supervisorStop = true;
+        }
+        supervisorCv.notify_all();
+        supervisor.join();
+    }
+    {
+        // Tasks still draining may try to grow the pool; from here on they can't
+        std::lock_guard<std::mutex> lock(resizeMtx);
+        acceptingWorkers = false;
+    }
     {
         std::lock_guard<std::mutex> lock(mtx);
         stop = true;
     }
     cv.notify_all();
 
-    for (auto &worker : workers)
-        worker.join();
+    for (auto &worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
 }
@@ -2,27 +2,429 @@
 #define SIMPLE_THREAD_POOL_H
 
 #include <vector>
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <functional>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <tuple>
+#include <type_traits>
+#include <iterator>
+#include <algorithm>
+#include <exception>
+#include <chrono>
+#include <string>
+#include <deque>
+#include "Task.h"
+#include "LaneQueue.h"
+#include "TaskHandle.h"
+
+enum class SchedulingMode {
+    SharedQueue,    // one queue + one mutex shared by every worker
+    WorkStealing    // one deque per worker, idle workers steal from the others
+};
+
+struct ThreadPoolOptions {
+    size_t threadCount = 0;              // 0 = one per pinned cpu, or hardware_concurrency()
+    SchedulingMode mode = SchedulingMode::SharedQueue;
+
+    // Worker i is pinned to cpus[i % cpus.size()]; empty leaves placement to the OS
+    std::vector<int> cpus;
+    bool onePerPhysicalCore = false;     // fill cpus with one hyperthread per core
+    std::string threadName;              // workers show up as "<threadName>-<i>"
+
+    // Elastic sizing: threadCount workers always run, up to maxThreads under load
+    size_t maxThreads = 0;                                // 0 or <= threadCount = fixed size
+    std::chrono::milliseconds idleTimeout{ 2000 };        // extra workers retire after idling this long
+    std::chrono::milliseconds maxQueueWait{ 5 };          // grow when work has waited this long with nobody idle
+    size_t backlogPerWorker = 8;                          // ...or at once when queued > live workers * this
+
+    // Share of the workers each priority lane gets while all of them have work
+    LaneQueue::Weights laneWeights{ 8, 4, 1 };
+};
+
+/*
+    Per-task scheduling hints. The deadline is the latest time the task may
+    START; it is checked when a worker picks the task up, and what happens
+    to a late one is up to onMissed.
+*/
+struct TaskOptions {
+    TaskPriority priority = TaskPriority::Normal;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    DeadlinePolicy onMissed = DeadlinePolicy::Drop;
+};
+
+struct PoolSizeSample {
+    std::chrono::steady_clock::time_point when;
+    size_t threads;
+};
+
+struct PoolStats {
+    size_t liveThreads;
+    size_t idleThreads;
+    size_t peakThreads;
+    size_t queuedTasks;
+    size_t missedDeadlines;     // late tasks, dropped or flagged
+    size_t droppedTasks;        // late tasks that were never run
+};
 
 class SimpleThreadPool {
 public:
-    SimpleThreadPool(size_t threadCount);
+    SimpleThreadPool(size_t threadCount, SchedulingMode mode = SchedulingMode::SharedQueue);
+    explicit SimpleThreadPool(const ThreadPoolOptions& options);
     ~SimpleThreadPool();
 
-    void addTask(std::function<void()> task);
+    size_t size() const { return liveWorkers.load(); }
+
+    // Elastic pools: current shape, and every size change since start (oldest first)
+    PoolStats stats();
+    std::vector<PoolSizeSample> sizeHistory();
+
+    // Called from a worker of this pool in WorkStealing mode the task goes to
+    // that worker's own deque, otherwise it is spread round-robin.
+    // Any callable converts to Task; small ones are queued without allocating.
+    // Without options the task goes to the Normal lane with no deadline.
+    void addTask(Task task, const TaskOptions& options = TaskOptions());
+
+    // True while this thread runs a task that started after its deadline
+    // (only possible with DeadlinePolicy::Flag)
+    static bool currentTaskIsLate();
+
+    /*
+        Publish a whole batch at once: one lock per queue touched instead of
+        one per task, and at most min(batch, sleeping) workers are woken.
+        The whole batch goes to the Normal lane.
+        The iterator form copies each element into a Task (use
+        std::make_move_iterator for move-only callables). The range form
+        moves out of rvalue ranges such as std::vector<Task>&&.
+    */
+    template<typename It>
+    void addTasks(It first, It last)
+    {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        if (count == 0)
+            return;
+
+        if (mode == SchedulingMode::WorkStealing) {
+            // A worker keeps the whole batch; an outside thread deals it out
+            // in contiguous chunks, one lock per deque. Counted before the push
+            // (see addTask); whatever was not pushed is given back on a throw.
+            size_t self;
+            size_t live = std::max<size_t>(liveWorkers.load(), 1);
+            size_t chunk = isOwnWorker(self) ? count : (count + live - 1) / live;
+            size_t queued = pendingTasks.fetch_add(count) + count;
+            size_t pushed = 0;
+            try {
+                while (first != last) {
+                    std::unique_lock<std::mutex> lock;
+                    WorkerQueue& target = lockSubmitQueue(lock);
+                    for (size_t i = 0; i < chunk && first != last; ++i, ++first, ++pushed)
+                        target.tasks.push_back(TaskPriority::Normal, QueuedTask{ Task(*first) });
+                }
+            }
+            catch (...) {
+                pendingTasks.fetch_sub(count - pushed);
+                if (pushed > 0)
+                    wakeWorkers(pushed);
+                throw;
+            }
+            wakeWorkers(count);
+            growIfBacklogged(queued);
+            return;
+        }
+
+        size_t sleeping, queued;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (; first != last; ++first)
+                tasks.push_back(TaskPriority::Normal, QueuedTask{ Task(*first) });
+            sleeping = sleepingWorkers;
+            queued = tasks.size();
+        }
+        notifyWorkers(count, sleeping);
+        growIfBacklogged(queued);
+    }
+
+    template<typename Range>
+    void addTasks(Range&& range)
+    {
+        if constexpr (std::is_lvalue_reference_v<Range>)
+            addTasks(std::begin(range), std::end(range));
+        else
+            addTasks(std::make_move_iterator(std::begin(range)), std::make_move_iterator(std::end(range)));
+    }
+
+    /*
+        Calls fn(i) for every i in [begin, end).
+        The range is halved recursively: the right half becomes a task
+        (stealable in WorkStealing mode), the current thread keeps the left.
+        A piece stops splitting at `grain` iterations, or earlier once it is
+        no bigger than an even share and no worker is idle to take the other
+        half. grain == 0 picks one from the range and thread count.
+        The caller runs pieces too and returns when the whole range is done;
+        the first exception thrown by fn is rethrown here.
+    */
+    template<typename Index, typename F>
+    void parallel_for(Index begin, Index end, size_t grain, F&& fn)
+    {
+        static_assert(std::is_integral_v<Index>, "parallel_for needs an integral index");
+        if (!(begin < end))
+            return;
+
+        size_t total = static_cast<size_t>(end - begin);
+        size_t threads = std::max<size_t>(liveWorkers.load(), 1);
+
+        auto state = std::make_shared<ParallelForState<std::remove_reference_t<F>>>();
+        state->fn = &fn;
+        state->grain = grain > 0 ? grain : std::max<size_t>(1, total / (threads * 8));
+        state->evenShare = std::max(state->grain, total / threads);
+
+        runRange(state, begin, end);
+
+        while (state->outstanding.load() > 0) {
+            if (runPendingTask())
+                continue;
+            std::unique_lock<std::mutex> lock(state->mtx);
+            state->cv.wait_for(lock, std::chrono::microseconds(100),
+                               [&state] { return state->outstanding.load() == 0; });
+        }
+
+        if (state->error)
+            std::rethrow_exception(state->error);
+    }
+
+    // Run f(args...) on the pool and hand back its result (or exception)
+    template<typename F, typename... Args>
+    auto submit(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
+    {
+        using ReturnType = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+        // Task is move-only, so the packaged_task goes in directly (no shared_ptr)
+        std::packaged_task<ReturnType()> task(
+            [func = std::forward<F>(f), params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(std::move(func), std::move(params));
+            });
+        std::future<ReturnType> future = task.get_future();
+
+        addTask(std::move(task));
+        return future;
+    }
+
+    /*
+        Task graph API. Nodes are scheduled on the pool the moment their inputs
+        complete, so a fan-out/fan-in pipeline never parks a worker in get():
+
+            auto a   = pool.spawn([] { return load(); });
+            auto b   = pool.then(a, [](const Data& d) { return parse(d); });
+            auto all = pool.when_all(std::vector<TaskHandle<int>>{ x, y, z });
+
+        An exception thrown by a node is rethrown by every node downstream of it.
+    */
+    template<typename F, typename... Args>
+    auto spawn(F&& f, Args&&... args)
+        -> TaskHandle<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>
+    {
+        using ReturnType = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+        auto node = std::make_shared<TaskState<ReturnType>>();
+        addTask([node, func = std::forward<F>(f), params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            auto call = [&]() { return std::apply(std::move(func), std::move(params)); };
+            node->run(call);
+        });
+        return TaskHandle<ReturnType>(node);
+    }
+
+    template<typename T, typename F>
+    auto then(const TaskHandle<T>& parent, F&& f) -> TaskHandle<typename ThenResult<T, std::decay_t<F>>::type>
+    {
+        using ReturnType = typename ThenResult<T, std::decay_t<F>>::type;
+
+        auto node = std::make_shared<TaskState<ReturnType>>();
+        std::shared_future<T> input = parent.state->future;
+        parent.state->onReady([this, node, input, func = std::forward<F>(f)]() mutable {
+            addTask([node, input, func = std::move(func)]() mutable {
+                auto call = [&]() -> ReturnType {
+                    if constexpr (std::is_void_v<T>) {
+                        input.get();            // rethrows a failed parent
+                        return func();
+                    } else {
+                        return func(input.get());
+                    }
+                };
+                node->run(call);
+            });
+        });
+        return TaskHandle<ReturnType>(node);
+    }
+
+    template<typename T>
+    TaskHandle<WhenAllResult<T>> when_all(const std::vector<TaskHandle<T>>& parents)
+    {
+        auto node = std::make_shared<TaskState<WhenAllResult<T>>>();
+
+        std::vector<std::shared_future<T>> inputs;
+        inputs.reserve(parents.size());
+        for (const auto& parent : parents)
+            inputs.push_back(parent.state->future);
+
+        auto schedule = [this, node, inputs]() {
+            addTask([node, inputs]() {
+                auto call = [&]() -> WhenAllResult<T> {
+                    if constexpr (std::is_void_v<T>) {
+                        for (const auto& input : inputs)
+                            input.get();
+                    } else {
+                        std::vector<T> values;
+                        values.reserve(inputs.size());
+                        for (const auto& input : inputs)
+                            values.push_back(input.get());
+                        return values;
+                    }
+                };
+                node->run(call);
+            });
+        };
+
+        if (parents.empty()) {
+            schedule();
+            return TaskHandle<WhenAllResult<T>>(node);
+        }
+
+        // The last parent to finish schedules the join node
+        auto remaining = std::make_shared<std::atomic<size_t>>(parents.size());
+        for (const auto& parent : parents) {
+            parent.state->onReady([remaining, schedule]() {
+                if (remaining->fetch_sub(1) == 1)
+                    schedule();
+            });
+        }
+        return TaskHandle<WhenAllResult<T>>(node);
+    }
 
 private:
-    void workerThread();
-    std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    template<typename F>
+    struct ParallelForState {
+        F* fn = nullptr;
+        size_t grain = 1;
+        size_t evenShare = 1;
+        std::atomic<size_t> outstanding{1};     // pieces not finished yet (caller's included)
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+    };
+
+    template<typename State, typename Index>
+    void runRange(const std::shared_ptr<State>& state, Index b, Index e)
+    {
+        try {
+            while (static_cast<size_t>(e - b) > state->grain
+                   && (static_cast<size_t>(e - b) > state->evenShare || sleepingWorkers.load() > 0)) {
+                Index mid = b + (e - b) / 2;
+                // Counted before it is queued so it cannot finish first and
+                // take outstanding to zero while this piece still runs
+                state->outstanding.fetch_add(1);
+                try {
+                    addTask([this, state, mid, e] { runRange(state, mid, e); });
+                } catch (...) {
+                    state->outstanding.fetch_sub(1);
+                    throw;
+                }
+                e = mid;
+            }
+
+            for (Index i = b; i < e && !state->failed.load(std::memory_order_relaxed); ++i)
+                (*state->fn)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state->mtx);
+            if (!state->error)
+                state->error = std::current_exception();
+            state->failed = true;
+        }
+
+        if (state->outstanding.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(state->mtx);
+            state->cv.notify_all();
+        }
+    }
+
+    // Per-worker deque: the owner pushes/pops at the back (LIFO, cache-hot),
+    // thieves take from the front (FIFO, oldest and usually biggest work).
+    // Each side still picks among the priority lanes by weight.
+    struct WorkerQueue {
+        explicit WorkerQueue(const LaneQueue::Weights& weights) : tasks(weights) {}
+
+        std::mutex mtx;
+        LaneQueue tasks;
+        std::atomic<bool> active{false};    // false once its worker retired: submitters skip it
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    void workerMain(size_t index);
+    void workerThread(size_t index);
+    void stealingWorkerThread(size_t index);
+    WorkerQueue& lockSubmitQueue(std::unique_lock<std::mutex>& lock);
+    bool popLocal(size_t index, QueuedTask& task);
+    bool steal(size_t thief, QueuedTask& task);
+    bool stealHigh(size_t thief, QueuedTask& task);
+    void runQueued(QueuedTask& entry);                  // deadline check, then run
+    bool isOwnWorker(size_t& index) const;
+    bool runPendingTask();                              // pop one queued task and run it here
+    void wakeWorkers(size_t count);
+    void notifyWorkers(size_t count, size_t sleeping);
+
+    bool elastic() const { return maxThreads > minThreads; }
+    bool idleWait(std::unique_lock<std::mutex>& lock);   // true when it timed out
+    bool spawnWorker(bool waitForSlot);
+    bool tryRetire();
+    void retireWorker(size_t index);
+    void growIfBacklogged(size_t queued);
+    size_t queuedTaskCount();
+    void supervisorThread();
+    void recordSize(size_t threads);
+
+    std::vector<std::thread> workers;     // maxThreads slots, started on demand
+    LaneQueue tasks;
 
     std::mutex mtx;
     std::condition_variable cv;
     bool stop;
+
+    SchedulingMode mode;
+    std::vector<std::unique_ptr<WorkerQueue>> localQueues;
+    std::atomic<size_t> pendingTasks;     // tasks sitting in any local deque
+    std::atomic<size_t> queuedHigh;       // ...of which in a High lane
+    std::atomic<size_t> sleepingWorkers;  // workers parked on cv (both modes)
+    std::atomic<size_t> nextQueue;        // round-robin cursor for outside submitters
+
+    std::vector<int> workerCpus;
+    std::string threadName;
+
+    // Elastic sizing; slot bookkeeping, history and spawning are under resizeMtx
+    size_t minThreads;
+    size_t maxThreads;
+    std::chrono::milliseconds idleTimeout;
+    std::chrono::milliseconds maxQueueWait;
+    size_t backlogPerWorker;
+
+    std::atomic<size_t> liveWorkers;
+    std::atomic<size_t> peakWorkers;
+    std::mutex resizeMtx;
+    std::vector<bool> slotInUse;
+    bool acceptingWorkers;
+    std::deque<PoolSizeSample> history;
+
+    std::thread supervisor;
+    std::mutex supervisorMtx;
+    std::condition_variable supervisorCv;
+    bool supervisorStop;
+
+    std::atomic<size_t> missedDeadlines;
+    std::atomic<size_t> droppedTasks;
 };
 
 #endif
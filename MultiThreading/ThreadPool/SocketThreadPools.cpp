@@ -0,0 +1,20 @@
+#include "SocketThreadPools.h"
+
+SocketThreadPools::SocketThreadPools(size_t threadsPerSocket, SchedulingMode mode, const CpuTopology& topology)
+{
+    for (size_t socket = 0; socket < topology.socketCount(); ++socket) {
+        ThreadPoolOptions options;
+        options.mode = mode;
+        options.threadName = "sock" + std::to_string(socket);
+
+        if (threadsPerSocket == 0) {
+            options.cpus = topology.onePerPhysicalCore(static_cast<int>(socket));
+        } else {
+            // Workers are pinned round-robin over every hyperthread of the socket
+            options.cpus = topology.cpusOfSocket(static_cast<int>(socket));
+            options.threadCount = threadsPerSocket;
+        }
+
+        pools.emplace_back(std::make_unique<SimpleThreadPool>(options));
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef SOCKET_THREAD_POOLS_H
+#define SOCKET_THREAD_POOLS_H
+
+#include "SimpleThreadPool.h"
+#include "CpuTopology.h"
+#include <vector>
+#include <memory>
+#include <functional>
+
+/*
+    One SimpleThreadPool per CPU socket, each pinned to that socket's CPUs.
+    Tasks that work on the same data should go to the same socket (forKey
+    does that by hashing), so they share its L3 cache. Memory they allocate
+    and touch first is also placed on that socket's NUMA node.
+*/
+class SocketThreadPools {
+public:
+    // threadsPerSocket == 0 -> one worker per physical core of the socket
+    explicit SocketThreadPools(size_t threadsPerSocket = 0,
+                               SchedulingMode mode = SchedulingMode::WorkStealing,
+                               const CpuTopology& topology = CpuTopology::detect());
+
+    size_t socketCount() const { return pools.size(); }
+    SimpleThreadPool& forSocket(size_t socket) { return *pools[socket % pools.size()]; }
+
+    template<typename K>
+    SimpleThreadPool& forKey(const K& key) { return forSocket(std::hash<K>{}(key)); }
+
+    void addTask(size_t socket, Task task) { forSocket(socket).addTask(std::move(task)); }
+
+private:
+    std::vector<std::unique_ptr<SimpleThreadPool>> pools;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+#include <type_traits>
+
+/*
+    Move-only replacement for std::function<void()>.
+    Callables up to InlineSize bytes (a lambda capturing a handful of
+    pointers/ints, a packaged_task, a shared_ptr + a few values) are stored
+    inside the Task itself, so building, queueing and running one does not
+    touch the heap. Anything bigger falls back to a single heap allocation.
+    The whole object is exactly one 64-byte cache line.
+*/
+class Task {
+public:
+    static constexpr size_t InlineSize = 64 - sizeof(void*);
+
+    Task() noexcept = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fitsInline<Fn>()) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &inlineOps<Fn>;
+        } else {
+            *reinterpret_cast<Fn**>(storage) = new Fn(std::forward<F>(f));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept { moveFrom(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void operator()() { ops->invoke(storage); }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*move)(void* dst, void* src) noexcept;   // move-construct dst, destroy src
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template<typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= InlineSize
+            && alignof(Fn) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template<typename Fn>
+    static constexpr Ops inlineOps = {
+        [](void* self) { (*static_cast<Fn*>(self))(); },
+        [](void* dst, void* src) noexcept {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* self) noexcept { static_cast<Fn*>(self)->~Fn(); }
+    };
+
+    template<typename Fn>
+    static constexpr Ops heapOps = {
+        [](void* self) { (**static_cast<Fn**>(self))(); },
+        [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* self) noexcept { delete *static_cast<Fn**>(self); }
+    };
+
+    void moveFrom(Task& other) noexcept {
+        if (other.ops) {
+            other.ops->move(storage, other.storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[InlineSize];
+    const Ops* ops = nullptr;
+};
+
+/*
+    Circular buffer of task slots, usable as a FIFO queue or as a deque.
+    Capacity is a power of two and only ever grows, so once the pool has seen
+    its peak backlog the slots are recycled and pushes stop allocating.
+    Not thread-safe: callers guard it with their own mutex.
+*/
+template<typename T>
+class SlotRing {
+public:
+    explicit SlotRing(size_t initialCapacity = 64) {
+        size_t capacity = 1;
+        while (capacity < initialCapacity)
+            capacity <<= 1;
+        slots.resize(capacity);
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push_back(T&& item) {
+        if (count == slots.size())
+            grow();
+        slots[(head + count) & (slots.size() - 1)] = std::move(item);
+        ++count;
+    }
+
+    T pop_front() {
+        T item = std::move(slots[head]);
+        head = (head + 1) & (slots.size() - 1);
+        --count;
+        return item;
+    }
+
+    T pop_back() {
+        --count;
+        return std::move(slots[(head + count) & (slots.size() - 1)]);
+    }
+
+private:
+    void grow() {
+        std::vector<T> bigger(slots.size() * 2);
+        for (size_t i = 0; i < count; ++i)
+            bigger[i] = std::move(slots[(head + i) & (slots.size() - 1)]);
+        slots.swap(bigger);
+        head = 0;
+    }
+
+    std::vector<T> slots;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+using TaskRing = SlotRing<Task>;
+
+#endif
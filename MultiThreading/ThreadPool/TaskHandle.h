@@ -0,0 +1,103 @@
+#ifndef TASK_HANDLE_H
+#define TASK_HANDLE_H
+
+#include <future>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include "Task.h"
+
+/*
+    Shared state of one node in a task graph.
+    std::future has no "call me when ready", so every node keeps its own list
+    of continuations. Whoever finishes the node runs them; a continuation
+    registered after completion runs straight away. Nobody ever blocks in
+    get() just to find out when a parent is done.
+*/
+template<typename T>
+struct TaskState {
+    std::promise<T> promise;
+    std::shared_future<T> future;
+
+    std::mutex mtx;
+    bool done = false;
+    std::vector<Task> continuations;
+
+    TaskState() : future(promise.get_future().share()) {}
+
+    template<typename Fn>
+    void run(Fn& fn) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                fn();
+                promise.set_value();
+            } else {
+                promise.set_value(fn());
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        finish();
+    }
+
+    void onReady(Task continuation) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!done) {
+                continuations.push_back(std::move(continuation));
+                return;
+            }
+        }
+        continuation();
+    }
+
+private:
+    void finish() {
+        std::vector<Task> ready;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done = true;
+            ready.swap(continuations);
+        }
+        for (auto& continuation : ready)
+            continuation();
+    }
+};
+
+// Handle to a node created by SimpleThreadPool::spawn / then / when_all
+template<typename T>
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    bool valid() const { return state != nullptr; }
+    bool ready() const {
+        return state->future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // Blocking accessors: meant for the final consumer outside the pool
+    void wait() const { state->future.wait(); }
+    decltype(auto) get() const { return state->future.get(); }
+    std::shared_future<T> future() const { return state->future; }
+
+private:
+    friend class SimpleThreadPool;
+
+    explicit TaskHandle(std::shared_ptr<TaskState<T>> s) : state(std::move(s)) {}
+
+    std::shared_ptr<TaskState<T>> state;
+};
+
+// Result of then(parent, fn): fn takes the parent's value, or nothing for void parents
+template<typename T, typename F>
+struct ThenResult { using type = std::invoke_result_t<F, const T&>; };
+
+template<typename F>
+struct ThenResult<void, F> { using type = std::invoke_result_t<F>; };
+
+// when_all over TaskHandle<T> yields every value in order, or just "done" for void
+template<typename T>
+using WhenAllResult = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+#endif
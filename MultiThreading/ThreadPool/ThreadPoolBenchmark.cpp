@@ -0,0 +1,541 @@
+#include "SimpleThreadPool.h"
+#include "SocketThreadPools.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+/*
+    Standalone benchmark (own main, excluded from the default build).
+    Build it on its own with the project's standard (C++17, as in ThreadPool.vcxproj), e.g.:
+        g++ -std=c++17 -O2 -pthread ThreadPoolBenchmark.cpp SimpleThreadPool.cpp CpuTopology.cpp SocketThreadPools.cpp
+*/
+
+using Clock = std::chrono::steady_clock;
+
+// Count every heap allocation in the process so we can report allocations per task
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    std::atomic<unsigned> sink{0};
+
+    // A few hundred ns of pure ALU work: short enough that queue overhead dominates
+    void tinyWork(unsigned seed)
+    {
+        unsigned x = seed | 1;
+        for (int i = 0; i < 64; ++i) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        if (x == 0)
+            sink.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const char* modeName(SchedulingMode mode)
+    {
+        return mode == SchedulingMode::WorkStealing ? "WorkStealing" : "SharedQueue";
+    }
+
+    // Every task is submitted from main: measures the cost of the submit/pop path
+    double flatTasksPerSec(size_t threads, SchedulingMode mode, int taskCount)
+    {
+        auto start = Clock::now();
+        {
+            SimpleThreadPool pool(threads, mode);
+            for (int i = 0; i < taskCount; ++i)
+                pool.addTask([i] { tinyWork(i); });
+        } // destructor drains the queue and joins
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return taskCount / elapsed.count();
+    }
+
+    // Root tasks fan out children from inside the pool (recursive/divide-and-conquer style)
+    double nestedTasksPerSec(size_t threads, SchedulingMode mode, int roots, int childrenPerRoot)
+    {
+        auto start = Clock::now();
+        {
+            SimpleThreadPool pool(threads, mode);
+            for (int r = 0; r < roots; ++r) {
+                pool.addTask([&pool, r, childrenPerRoot] {
+                    for (int c = 0; c < childrenPerRoot; ++c)
+                        pool.addTask([r, c] { tinyWork(r * 31 + c); });
+                });
+            }
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return double(roots) * (childrenPerRoot + 1) / elapsed.count();
+    }
+
+    // The pre-Task design: std::queue<std::function<void()>> and a copy on pop
+    class LegacyPool {
+    public:
+        explicit LegacyPool(size_t threadCount) : stop(false) {
+            for (size_t i = 0; i < threadCount; ++i)
+                workers.emplace_back(&LegacyPool::workerThread, this);
+        }
+
+        ~LegacyPool() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stop = true;
+            }
+            cv.notify_all();
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        void addTask(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                tasks.push(task);
+            }
+            cv.notify_one();
+        }
+
+    private:
+        void workerThread() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    while (stop == false && tasks.empty())
+                        cv.wait(lock);
+                    if (stop && tasks.empty())
+                        return;
+                    task = tasks.front();
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool stop;
+    };
+
+    struct AllocationResult {
+        double allocsPerTask;
+        double nsPerTask;
+    };
+
+    // Submit a batch, wait for it, repeat: the second round is steady state
+    // (queue storage already grown), which is what we report.
+    template<typename Pool>
+    AllocationResult measureAllocations(Pool& pool, int taskCount)
+    {
+        std::atomic<int> done{0};
+        AllocationResult result{};
+        for (int round = 0; round < 2; ++round) {
+            done = 0;
+            size_t allocsBefore = allocationCount.load();
+            auto start = Clock::now();
+
+            for (int i = 0; i < taskCount; ++i) {
+                // 32 bytes of capture: already too big for std::function's inline buffer
+                long seed = i;
+                double scale = 1.5;
+                unsigned salt = round;
+                pool.addTask([&done, seed, scale, salt] {
+                    tinyWork(unsigned(seed * scale) ^ salt);
+                    done.fetch_add(1, std::memory_order_release);
+                });
+            }
+            while (done.load(std::memory_order_acquire) < taskCount)
+                std::this_thread::yield();
+
+            std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+            result.allocsPerTask = double(allocationCount.load() - allocsBefore) / taskCount;
+            result.nsPerTask = elapsed.count() / taskCount;
+        }
+        return result;
+    }
+
+    void allocationBenchmark()
+    {
+        const int taskCount = 200000;
+        std::cout << "\n--- Task storage (1 worker, " << taskCount << " tasks, steady state) ---\n";
+        std::cout << std::left << std::setw(34) << "design"
+                  << std::right << std::setw(14) << "allocs/task" << std::setw(12) << "ns/task" << "\n";
+
+        auto print = [](const char* name, AllocationResult r) {
+            std::cout << std::left << std::setw(34) << name << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(14) << r.allocsPerTask
+                      << std::setprecision(1) << std::setw(12) << r.nsPerTask << "\n";
+        };
+
+        {
+            LegacyPool pool(1);
+            print("before: queue<std::function> + copy", measureAllocations(pool, taskCount));
+        }
+        {
+            SimpleThreadPool pool(1, SchedulingMode::SharedQueue);
+            print("after: Task + TaskRing (shared)", measureAllocations(pool, taskCount));
+        }
+        {
+            SimpleThreadPool pool(1, SchedulingMode::WorkStealing);
+            print("after: Task + TaskRing (stealing)", measureAllocations(pool, taskCount));
+        }
+    }
+
+    // Time from first submit until every task has run (pool teardown drains and joins)
+    template<typename Submit>
+    double noopTasksPerSec(size_t threads, SchedulingMode mode, int taskCount, Submit submit)
+    {
+        auto pool = std::make_unique<SimpleThreadPool>(threads, mode);
+        auto start = Clock::now();
+        submit(*pool);
+        pool.reset();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return taskCount / elapsed.count();
+    }
+
+    // addTasks still builds and queues one Task per element; it only saves
+    // the per-task lock and wakeup. That is about 3x over addTask with the
+    // shared queue and next to nothing with work stealing, where addTask
+    // already locks a single deque - not an order of magnitude. Only
+    // parallel_for gets there, by queueing one task per split, not per index.
+    void batchBenchmark()
+    {
+        const int taskCount = 1000000;
+        const size_t threads = std::max(4u, std::thread::hardware_concurrency());
+        const SchedulingMode modes[] = { SchedulingMode::SharedQueue, SchedulingMode::WorkStealing };
+
+        std::cout << "\n--- " << taskCount << " no-op tasks, " << threads << " threads ---\n";
+        std::cout << std::left << std::setw(14) << "mode" << std::right
+                  << std::setw(16) << "addTask/s" << std::setw(16) << "addTasks/s" << std::setw(18) << "parallel_for/s" << "\n";
+
+        for (SchedulingMode mode : modes) {
+            double single = noopTasksPerSec(threads, mode, taskCount, [&](SimpleThreadPool& pool) {
+                for (int i = 0; i < taskCount; ++i)
+                    pool.addTask([] {});
+            });
+
+            std::vector<Task> batch;
+            batch.reserve(taskCount);
+            for (int i = 0; i < taskCount; ++i)
+                batch.emplace_back([] {});
+            double batched = noopTasksPerSec(threads, mode, taskCount, [&](SimpleThreadPool& pool) {
+                pool.addTasks(std::move(batch));
+            });
+
+            double ranged = noopTasksPerSec(threads, mode, taskCount, [&](SimpleThreadPool& pool) {
+                pool.parallel_for(0, taskCount, 0, [](int) {});
+            });
+
+            std::cout << std::left << std::setw(14) << modeName(mode) << std::right << std::fixed
+                      << std::setprecision(0) << std::setw(16) << single << std::setw(16) << batched
+                      << std::setw(18) << ranged << "\n";
+        }
+    }
+
+    // Sum one shard: pure streaming reads, bound by memory bandwidth and cache locality
+    uint64_t sumShard(const std::vector<uint64_t>& shard)
+    {
+        uint64_t total = 0;
+        for (uint64_t v : shard)
+            total += v;
+        return total;
+    }
+
+    // poolFor(s): the pool that allocates (first touch) and later sweeps shard s
+    using PoolForShard = std::function<SimpleThreadPool&(size_t shard)>;
+
+    double memoryBoundGBPerSec(size_t shardCount, size_t shardElements, int passes, const PoolForShard& poolFor)
+    {
+        std::vector<std::vector<uint64_t>> shards(shardCount);
+
+        // First touch from the worker side so each shard lands on its socket's NUMA node
+        std::vector<std::future<void>> ready;
+        for (size_t s = 0; s < shardCount; ++s) {
+            ready.push_back(poolFor(s).submit([&shards, s, shardElements] {
+                shards[s].assign(shardElements, s + 1);
+            }));
+        }
+        for (auto& f : ready)
+            f.get();
+
+        auto start = Clock::now();
+        std::vector<std::future<uint64_t>> sums;
+        for (int pass = 0; pass < passes; ++pass) {
+            for (size_t s = 0; s < shardCount; ++s)
+                sums.push_back(poolFor(s).submit([&shards, s] { return sumShard(shards[s]); }));
+        }
+        uint64_t checksum = 0;
+        for (auto& f : sums)
+            checksum += f.get();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        if (checksum == 0)
+            std::cout << "(checksum 0)\n";
+        double bytes = double(shardCount) * shardElements * sizeof(uint64_t) * passes;
+        return bytes / elapsed.count() / 1e9;
+    }
+
+    void affinityBenchmark()
+    {
+        CpuTopology topology = CpuTopology::detect();
+        size_t cores = topology.onePerPhysicalCore().size();
+        size_t shardCount = std::max<size_t>(4, cores * 2);
+        const size_t shardElements = 1 << 21;    // 16 MB per shard
+        const int passes = 8;
+
+        std::cout << "\n--- Memory-bound sweep: " << shardCount << " x 16 MB shards, " << passes << " passes, "
+                  << topology.cpus().size() << " cpus / " << cores << " cores / "
+                  << topology.socketCount() << " sockets ---\n";
+
+        auto print = [](const char* name, double gbPerSec) {
+            std::cout << std::left << std::setw(40) << name << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(10) << gbPerSec << " GB/s\n";
+        };
+
+        {
+            SimpleThreadPool pool(cores, SchedulingMode::SharedQueue);
+            print("unpinned, one shared pool", memoryBoundGBPerSec(shardCount, shardElements, passes,
+                [&pool](size_t) -> SimpleThreadPool& { return pool; }));
+        }
+        {
+            ThreadPoolOptions options;
+            options.onePerPhysicalCore = true;
+            options.threadName = "bench";
+            SimpleThreadPool pool(options);
+            print("pinned one per physical core", memoryBoundGBPerSec(shardCount, shardElements, passes,
+                [&pool](size_t) -> SimpleThreadPool& { return pool; }));
+        }
+        {
+            SocketThreadPools pools(0, SchedulingMode::SharedQueue, topology);
+            print("pinned per-socket pools, shard affinity", memoryBoundGBPerSec(shardCount, shardElements, passes,
+                [&pools](size_t shard) -> SimpleThreadPool& { return pools.forSocket(shard); }));
+        }
+    }
+
+    struct LatencyReport {
+        double p50Ms;
+        double p99Ms;
+        double maxMs;
+        size_t peakThreads;
+        size_t finalThreads;
+    };
+
+    /*
+        Soak: bursts of blocking (I/O-like) tasks with quiet gaps in between.
+        Latency is queue wait, i.e. from addTask until the task starts running.
+    */
+    LatencyReport burstSoak(const ThreadPoolOptions& options, int bursts, int tasksPerBurst)
+    {
+        SimpleThreadPool pool(options);
+        std::mutex latencyMtx;
+        std::vector<double> latencies;
+        std::atomic<int> done{0};
+
+        for (int burst = 0; burst < bursts; ++burst) {
+            for (int i = 0; i < tasksPerBurst; ++i) {
+                auto queuedAt = Clock::now();
+                pool.addTask([&, queuedAt] {
+                    std::chrono::duration<double, std::milli> waited = Clock::now() - queuedAt;
+                    {
+                        std::lock_guard<std::mutex> lock(latencyMtx);
+                        latencies.push_back(waited.count());
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    done.fetch_add(1);
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        while (done.load() < bursts * tasksPerBurst)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // Quiet period: the extra workers should retire
+        std::this_thread::sleep_for(options.idleTimeout * 3);
+
+        std::sort(latencies.begin(), latencies.end());
+        LatencyReport report;
+        report.p50Ms = latencies[latencies.size() / 2];
+        report.p99Ms = latencies[latencies.size() * 99 / 100];
+        report.maxMs = latencies.back();
+        report.peakThreads = pool.stats().peakThreads;
+        report.finalThreads = pool.size();
+        return report;
+    }
+
+    void elasticSoak()
+    {
+        const int bursts = 20;
+        const int tasksPerBurst = 200;
+
+        std::cout << "\n--- Burst soak: " << bursts << " bursts x " << tasksPerBurst
+                  << " blocking 2ms tasks, 100ms apart ---\n";
+        std::cout << std::left << std::setw(26) << "pool" << std::right << std::setw(10) << "p50 ms"
+                  << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+                  << std::setw(8) << "peak" << std::setw(8) << "final" << "\n";
+
+        auto print = [](const char* name, const LatencyReport& r) {
+            std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(10) << r.p50Ms << std::setw(10) << r.p99Ms << std::setw(10) << r.maxMs
+                      << std::setw(8) << r.peakThreads << std::setw(8) << r.finalThreads << "\n";
+        };
+
+        ThreadPoolOptions fixed;
+        fixed.threadCount = 4;
+        fixed.idleTimeout = std::chrono::milliseconds(200);
+        print("fixed 4", burstSoak(fixed, bursts, tasksPerBurst));
+
+        ThreadPoolOptions elastic = fixed;
+        elastic.maxThreads = 64;
+        print("elastic 4..64 (shared)", burstSoak(elastic, bursts, tasksPerBurst));
+
+        elastic.mode = SchedulingMode::WorkStealing;
+        print("elastic 4..64 (stealing)", burstSoak(elastic, bursts, tasksPerBurst));
+    }
+
+    void spinFor(std::chrono::microseconds duration)
+    {
+        auto end = Clock::now() + duration;
+        while (Clock::now() < end) {
+        }
+    }
+
+    struct LaneReport {
+        double p50Ms;
+        double p99Ms;
+        size_t dropped;
+        int lowDone;    // flood tasks finished while the probes were being sent
+    };
+
+    /*
+        Saturate the Low lane with CPU-bound 200us tasks, then send probe tasks
+        one per millisecond on probeLane and measure how long each waited.
+        A probeDeadline > 0 gives every probe that deadline (DeadlinePolicy::Drop).
+    */
+    LaneReport probeLatency(SchedulingMode mode, int floodTasks, TaskPriority probeLane,
+                            std::chrono::milliseconds probeDeadline)
+    {
+        const int probes = 200;
+        SimpleThreadPool pool(4, mode);
+        std::atomic<int> lowDone{0};
+
+        TaskOptions low;
+        low.priority = TaskPriority::Low;
+        for (int i = 0; i < floodTasks; ++i) {
+            pool.addTask([&lowDone] {
+                spinFor(std::chrono::microseconds(200));
+                lowDone.fetch_add(1);
+            }, low);
+        }
+
+        std::mutex latencyMtx;
+        std::vector<double> latencies;
+        std::atomic<int> probesRun{0};
+        int lowAtStart = lowDone.load();
+
+        for (int i = 0; i < probes; ++i) {
+            auto queuedAt = Clock::now();
+            TaskOptions options;
+            options.priority = probeLane;
+            if (probeDeadline.count() > 0)
+                options.deadline = queuedAt + probeDeadline;
+
+            pool.addTask([&, queuedAt] {
+                std::chrono::duration<double, std::milli> waited = Clock::now() - queuedAt;
+                {
+                    std::lock_guard<std::mutex> lock(latencyMtx);
+                    latencies.push_back(waited.count());
+                }
+                probesRun.fetch_add(1);
+            }, options);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        int lowDuring = lowDone.load() - lowAtStart;
+
+        while (probesRun.load() + static_cast<int>(pool.stats().droppedTasks) < probes)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        LaneReport report{ 0.0, 0.0, pool.stats().droppedTasks, lowDuring };
+        std::sort(latencies.begin(), latencies.end());
+        if (!latencies.empty()) {
+            report.p50Ms = latencies[latencies.size() / 2];
+            report.p99Ms = latencies[latencies.size() * 99 / 100];
+        }
+        return report;
+    }
+
+    void priorityBenchmark()
+    {
+        const int flood = 8000;
+
+        std::cout << "\n--- Priority lanes: 4 threads, " << flood << " x 200us tasks on the Low lane, "
+                  << "200 probes 1ms apart ---\n";
+        std::cout << std::left << std::setw(44) << "probes" << std::right << std::setw(10) << "p50 ms"
+                  << std::setw(10) << "p99 ms" << std::setw(10) << "dropped" << std::setw(10) << "low done" << "\n";
+
+        for (SchedulingMode mode : { SchedulingMode::SharedQueue, SchedulingMode::WorkStealing }) {
+            auto print = [mode](const char* name, const LaneReport& r) {
+                std::cout << std::left << std::setw(44) << (std::string(modeName(mode)) + ", " + name)
+                          << std::right << std::fixed << std::setprecision(2)
+                          << std::setw(10) << r.p50Ms << std::setw(10) << r.p99Ms
+                          << std::setw(10) << r.dropped << std::setw(10) << r.lowDone << "\n";
+            };
+
+            print("idle pool, High lane",
+                  probeLatency(mode, 0, TaskPriority::High, std::chrono::milliseconds(0)));
+            print("behind the flood (same lane)",
+                  probeLatency(mode, flood, TaskPriority::Low, std::chrono::milliseconds(0)));
+            print("same lane, 5ms deadline",
+                  probeLatency(mode, flood, TaskPriority::Low, std::chrono::milliseconds(5)));
+            print("High lane",
+                  probeLatency(mode, flood, TaskPriority::High, std::chrono::milliseconds(0)));
+        }
+    }
+}
+
+int main()
+{
+    const int taskCount = 200000;
+    const int roots = 2000;
+    const int childrenPerRoot = 100;
+    const size_t threadCounts[] = { 1, 2, 4, 8, 16 };
+    const SchedulingMode modes[] = { SchedulingMode::SharedQueue, SchedulingMode::WorkStealing };
+
+    std::cout << "hardware_concurrency = " << std::thread::hardware_concurrency() << "\n\n";
+    std::cout << std::left << std::setw(9) << "threads" << std::setw(14) << "mode"
+              << std::right << std::setw(16) << "flat tasks/s" << std::setw(18) << "nested tasks/s" << "\n";
+
+    for (size_t threads : threadCounts) {
+        for (SchedulingMode mode : modes) {
+            double flat = flatTasksPerSec(threads, mode, taskCount);
+            double nested = nestedTasksPerSec(threads, mode, roots, childrenPerRoot);
+            std::cout << std::left << std::setw(9) << threads << std::setw(14) << modeName(mode)
+                      << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(16) << flat << std::setw(18) << nested << "\n";
+        }
+    }
+
+    allocationBenchmark();
+    batchBenchmark();
+    affinityBenchmark();
+    elasticSoak();
+    priorityBenchmark();
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "SimpleThreadPool.h"
 #include <iostream>
 #include <chrono>
+#include <vector>
+#include <future>
 
 int main() {
     SimpleThreadPool pool(3); // 3 worker threads
@@ -16,6 +18,82 @@ int main() {
     }
 
     std::this_thread::sleep_for(std::chrono::seconds(3));
+
+    // Work-stealing pool: children added from inside a task land on that
+    // worker's own deque; idle workers steal them from the other end.
+    SimpleThreadPool stealingPool(3, SchedulingMode::WorkStealing);
+    stealingPool.addTask([&stealingPool] {
+        for (int i = 1; i <= 5; i++) {
+            stealingPool.addTask([i] {
+                std::cout << "Child " << i << " running on thread "
+                          << std::this_thread::get_id()
+                          << std::endl;
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            });
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    // Futures and a small fan-out / fan-in graph
+    std::future<int> answer = pool.submit([](int a, int b) { return a * b; }, 6, 7);
+    std::cout << "submit() result: " << answer.get() << std::endl;
+
+    std::vector<TaskHandle<int>> squares;
+    for (int i = 1; i <= 4; i++)
+        squares.push_back(pool.spawn([i] { return i * i; }));
+
+    auto total = pool.then(pool.when_all(squares), [](const std::vector<int>& values) {
+        int sum = 0;
+        for (int v : values)
+            sum += v;
+        return sum;
+    });
+    std::cout << "Sum of squares 1..4: " << total.get() << std::endl;
+
+    // Bulk work: one call instead of thousands of addTask()s
+    std::vector<int> values(100000);
+    pool.parallel_for(size_t(0), values.size(), 0, [&values](size_t i) {
+        values[i] = static_cast<int>(i % 10);
+    });
+    long long checksum = 0;
+    for (int v : values)
+        checksum += v;
+    std::cout << "parallel_for checksum: " << checksum << std::endl;
+
+    // Pinned, named workers: one per physical core, shown as "pinned-<i>" in debuggers/top
+    ThreadPoolOptions options;
+    options.onePerPhysicalCore = true;
+    options.threadName = "pinned";
+    SimpleThreadPool pinnedPool(options);
+    std::cout << "Pinned pool runs " << pinnedPool.size() << " workers" << std::endl;
+
+    // Priority lanes and deadlines: the urgent task overtakes the backlog.
+    // The stale one queues in the Low lane behind at least 40ms of 10ms tasks,
+    // so its 1ms deadline has long passed when it comes up and it is dropped.
+    {
+        SimpleThreadPool lanePool(1);
+        TaskOptions low;
+        low.priority = TaskPriority::Low;
+        for (int i = 0; i < 5; ++i)
+            lanePool.addTask([] { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }, low);
+
+        TaskOptions urgent;
+        urgent.priority = TaskPriority::High;
+        lanePool.addTask([] { std::cout << "High lane task ran ahead of the backlog" << std::endl; }, urgent);
+
+        TaskOptions stale = low;
+        stale.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+        lanePool.addTask([] { std::cout << "never printed" << std::endl; }, stale);
+
+        // Same lane, so it runs after the stale task has been dealt with
+        std::promise<void> drained;
+        lanePool.addTask([&drained] { drained.set_value(); }, low);
+        drained.get_future().wait();
+        std::cout << "Dropped after deadline: " << lanePool.stats().droppedTasks << std::endl;
+    }
+
     std::cout << "Main exit\n";
     return 0;
 }